@@ -0,0 +1,96 @@
+#!/bin/sh
+# Builds the Headless configuration of every chapter that has one (HEADLESS
+# defined, see Headless.h), runs them through a fixed set of scenarios and
+# collects their frame time percentiles, one JSON object per line, in a single
+# file to diff between commits. Run it from the top of the repository.
+#
+#   ./benchmark.sh [results.json]
+#
+# Set CINDER_PATH or OSMESA_PATH to override the projects' defaults. With
+# TRACE=1 the apps are built with TRACE defined as well (see Trace.h) and each
+# scenario writes its zones to build/headless/traces/<app> <scenario>.json.
+
+out=${1:-benchmark.json}
+build=$(pwd)/build/headless
+frames=300
+size=800x600
+rm -f "$out"
+
+# build <name> <project>: builds project into $build/<name> and links the
+# executable as $build/<name>/<name>
+build() {
+	name=$1; project=$2
+	xcodebuild -project "$project" -configuration Headless SYMROOT="$build/$name" \
+		${CINDER_PATH:+CINDER_PATH="$CINDER_PATH"} ${OSMESA_PATH:+OSMESA_PATH="$OSMESA_PATH"} \
+		${TRACE:+GCC_PREPROCESSOR_DEFINITIONS="HEADLESS TRACE"} build > "$build/$name.log" 2>&1 \
+		|| { echo "$name did not build, see $build/$name.log" >&2; return 1; }
+	ln -sf "$(ls -d "$build/$name"/Headless/*.app)/Contents/MacOS/"* "$build/$name/$name"
+}
+
+# osmesa <name>: the p5drawing chapters link OSMesa ahead of OpenGL.framework
+# (which still provides CGL), so every gl call must bind to libOSMesa; one
+# bound to OpenGL.framework would run without a context. The executable is
+# unlinked if any does, so its scenarios fail instead of measuring garbage.
+osmesa() {
+	name=$1; exe="$build/$name/$name"
+	[ -e "$exe" ] || return 1
+	wrong=$(nm -m "$exe" | grep ' external _gl[A-Z]' | grep -v '(from libOSMesa)')
+	if [ -n "$wrong" ]; then
+		echo "$name: gl calls not bound to libOSMesa:" >&2
+		echo "$wrong" >&2
+		rm -f "$exe"
+		return 1
+	fi
+}
+
+mkdir -p "$build" "$build/traces"
+build CairoCh3 cairo/CairoCh3/xcode/Cairo.xcodeproj
+build CairoCh4 cairo/CairoCh4/xcode/Cairo.xcodeproj
+build CairoCh5 cairo/CairoCh5/xcode/Cairo.xcodeproj
+build p5drawingCh5 p5drawing/p5drawingCh5/xcode/p5drawing.xcodeproj && osmesa p5drawingCh5
+build p5drawingCh6 p5drawing/p5drawingCh6/xcode/p5drawing.xcodeproj && osmesa p5drawingCh6
+
+run() {
+	app=$1; name=$2; shift 2
+	echo "$app $name"
+	TRACE_FILE="$build/traces/$app $name.json" "$build/$app/$app" --frames $frames --size $size --bench "$out" --name "$app $name" "$@" || echo "$app $name failed" >&2
+}
+
+run CairoCh3 cairo --kernel 0
+run CairoCh3 kernel --kernel 1
+
+for cell in 4 10 25 60; do
+	run CairoCh4 "cellSize $cell" --resources cairo/CairoCh4/resources/ --cell-size $cell
+done
+run CairoCh4 "cellSize 10 single thread" --resources cairo/CairoCh4/resources/ --cell-size 10 --bands 0
+run CairoCh4 "cellSize 10 palette 8" --resources cairo/CairoCh4/resources/ --cell-size 10 --palette 8
+
+for cell in 6 10 20; do
+	run CairoCh5 "cellSize $cell" --resources cairo/CairoCh5/resources/ --cell-size $cell
+done
+# prints the old Surface32f cell loop, PlanarImage sums and the summed-area table side by side to stdout
+run CairoCh5 "cell means" --resources cairo/CairoCh5/resources/ --frames 1 --mean-benchmark 1
+# prints the heap and gradient draw time of the old list<Droplet> layout next to DropletField
+for cell in 6 10; do
+	run CairoCh5 "layouts at cellSize $cell" --resources cairo/CairoCh5/resources/ --frames 1 --cell-size $cell --layout-benchmark 1
+done
+
+# circles keep spawning every frame, so measure after 10 and 30 seconds of it
+run p5drawingCh5 "after 10s" --warmup 600
+run p5drawingCh5 "after 30s" --warmup 1800
+run p5drawingCh5 "1000 per frame after 10s" --warmup 600 --spawn 1000
+run p5drawingCh5 "1000 per frame after 10s serial" --warmup 600 --spawn 1000 --parallel 0
+run p5drawingCh5 "after 10s, a draw call per circle" --warmup 600 --batch 0
+run p5drawingCh5 "after 10s without collisions" --warmup 600 --collide 0
+# piles settle and fall asleep from the bottom up, so compare with sleeping off
+run p5drawingCh5 "after 30s without sleeping" --warmup 1800 --sleep 0
+run p5drawingCh5 "after 30s, at most 1000 circles" --warmup 1800 --max-circles 1000
+# without collisions most circles come to rest on the bottom edge and fall asleep
+run p5drawingCh5 "after 30s without collisions" --warmup 1800 --collide 0
+run p5drawingCh5 "after 30s without collisions or sleeping" --warmup 1800 --collide 0 --sleep 0
+# prints grid build and collision times for 10k to 4M circles to stdout
+run p5drawingCh5 "grid benchmark" --frames 1 --grid-benchmark 1
+
+run p5drawingCh6 "synthetic stroke" --warmup 120 --stroke 1
+
+echo "results in $out"
@@ -0,0 +1,31 @@
+#pragma once
+#include "cinder/cairo/Cairo.h"
+
+using namespace ci;
+using namespace std;
+
+// Owns two window-sized image surfaces, each with a persistent cairo context,
+// plus a context on the window itself. Surfaces and contexts are only rebuilt
+// when the window size changes, so draw() no longer creates a surface and
+// context every frame. Each frame draws into the back buffer, which present()
+// paints onto the window; the other buffer keeps the previous frame.
+class WindowBuffers {
+public:
+	WindowBuffers();
+	
+	// Swaps buffers and returns the context of the new back buffer, reallocating
+	// everything first if the window is not width x height anymore
+	cairo::Context& begin(int width, int height);
+	// Paints the back buffer onto the window
+	void present();
+	
+	cairo::SurfaceImage& getBack() { return mBuffers[mBack]; }
+	// The frame presented before the current one
+	cairo::SurfaceImage& getFront() { return mBuffers[1 - mBack]; }
+	
+	int mWidth, mHeight;
+	int mBack;
+	cairo::SurfaceImage mBuffers[2];
+	cairo::Context mContexts[2];
+	cairo::Context mWindow;
+};
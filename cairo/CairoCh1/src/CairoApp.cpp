@@ -1,5 +1,7 @@
 #include "cinder/app/AppBasic.h"
 #include "cinder/cairo/Cairo.h"
+#include "WindowBuffers.h"
+#include "Trace.h"
 using namespace ci;
 using namespace ci::app;
 using namespace std;
@@ -10,21 +12,33 @@ public:
 	void setup();
 	void update();
 	void draw();
+	void keyDown(KeyEvent event);
+	WindowBuffers buffers;
 };
 
+void cairoApp::keyDown(KeyEvent event)
+{
+	if( event.getCode() == KeyEvent::KEY_F1 ) {
+		Trace::write();
+	}
+}
+
 void cairoApp::setup()
 {
 }
 
 void cairoApp::update()
 {
+	TRACE_ZONE("update");
 }
 
 void cairoApp::draw()
 {
-	cairo::Context ctx( cairo::createWindowSurface() );     
+	TRACE_ZONE("draw");
+	cairo::Context &ctx = buffers.begin( getWindowWidth(), getWindowHeight() );
 	ctx.setSource( Colorf(0,0,0) );
 	ctx.paint();
+	buffers.present();
 }
 
 CINDER_APP_BASIC( cairoApp, Renderer2d )
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+#include "cinder/cairo/Cairo.h"
+#include "cinder/Shape2d.h"
+#include "cinder/Rect.h"
+#include <boost/function.hpp>
+#include <vector>
+
+using namespace ci;
+using namespace std;
+
+// One shape of a retained scene: a cached path, filled and/or stroked
+class SceneNode {
+public:
+	SceneNode();
+	
+	void draw(cairo::Context &ctx) const;
+	// Recomputes mBounds from the path and line width
+	void updateBounds();
+	
+	Shape2d mPath;
+	bool mFill;
+	Colorf mFillColor;
+	// 0 draws no stroke
+	float mLineWidth;
+	Colorf mStrokeColor;
+	// the Scene::Input flags the path and colors are built from
+	uint32_t mInputs;
+	// everything the node touches, antialiasing and stroke included
+	Rectf mBounds;
+};
+
+// A retained list of nodes drawn back to front. A node's path is only rebuilt
+// when one of the inputs it depends on changes, and only the rectangles the
+// changed nodes covered before and after are repainted, clipped, with every
+// node that reaches into them. With nothing changed, repaint() draws nothing.
+// The target is expected to alternate between two buffers (see WindowBuffers),
+// so each frame also repaints the previous frame's damage, which the buffer
+// being drawn into has not seen yet.
+class Scene {
+public:
+	enum Input { WINDOW_SIZE = 1, MOUSE_LOCATION = 2, MOUSE_PRESSED = 4 };
+	typedef boost::function<void (SceneNode&)> BuildFn;
+	
+	// Adds a node on top of the others; build fills in its path and colors
+	void add(uint32_t inputs, BuildFn build);
+	// Rebuilds the nodes depending on any of inputs and damages their old and new bounds
+	void invalidate(uint32_t inputs);
+	void damage(const Rectf &rect);
+	bool isDamaged() const;
+	
+	// Repaints the damaged parts of ctx over background and clears the damage
+	void repaint(cairo::Context &ctx, const Colorf &background);
+	
+	vector<SceneNode> mNodes;
+	vector<BuildFn> mBuilders;
+	vector<Rectf> mDamage, mPreviousDamage;
+};
@@ -1,5 +1,9 @@
 #include "cinder/app/AppBasic.h"
 #include "cinder/cairo/cairo.h"
+#include "WindowBuffers.h"
+#include "Trace.h"
+#include "Scene.h"
+#include <boost/bind.hpp>
 using namespace ci;
 using namespace ci::app;
 using namespace std;
@@ -13,98 +17,198 @@ public:
 	void mouseMove(MouseEvent event);
 	void mouseDown(MouseEvent event);
 	void mouseUp(MouseEvent event);
+	void keyDown(KeyEvent event);
+	void wake();
+	
+	Vec2f getCenter();
+	void buildSquare(SceneNode &node);
+	void buildEyes(SceneNode &node);
+	void buildPupils(SceneNode &node);
+	void buildBrows(SceneNode &node);
+	void buildMouth(SceneNode &node);
+	
 	Vec2f mouseLocation;
 	bool mousePressed;
+	WindowBuffers buffers;
+	
+	// the face as retained nodes; only what the mouse changes gets repainted
+	Scene scene;
+	Vec2i windowSize;
+	// frames since anything was repainted; after IDLE_FRAMES the app drops to IDLE_FRAME_RATE
+	int idleFrames;
 };
 
+static const int IDLE_FRAMES = 30;
+static const float IDLE_FRAME_RATE = 4.0f;
+static const float FRAME_RATE = 60.0f;
+
 void cairoApp::mouseDown(MouseEvent event)
 {
 	mousePressed = true;
+	scene.invalidate( Scene::MOUSE_PRESSED );
+	wake();
 }
 
 void cairoApp::mouseUp(MouseEvent event)
 {
 	mousePressed = false;
+	scene.invalidate( Scene::MOUSE_PRESSED );
+	wake();
 }
 
 void cairoApp::mouseMove(MouseEvent event)
 {
 	mouseLocation = event.getPos();
+	scene.invalidate( Scene::MOUSE_LOCATION );
+	wake();
+}
+
+void cairoApp::keyDown(KeyEvent event)
+{
+	if( event.getCode() == KeyEvent::KEY_F1 ) {
+		Trace::write();
+	}
+}
+
+void cairoApp::wake()
+{
+	if( idleFrames >= IDLE_FRAMES ) {
+		setFrameRate( FRAME_RATE );
+	}
+	idleFrames = 0;
 }
 
 void cairoApp::setup()
 {
+	mousePressed = false;
+	idleFrames = 0;
+	scene.add( Scene::WINDOW_SIZE, boost::bind(&cairoApp::buildSquare, this, _1) );
+	scene.add( Scene::WINDOW_SIZE | Scene::MOUSE_PRESSED, boost::bind(&cairoApp::buildEyes, this, _1) );
+	scene.add( Scene::WINDOW_SIZE | Scene::MOUSE_PRESSED | Scene::MOUSE_LOCATION, boost::bind(&cairoApp::buildPupils, this, _1) );
+	scene.add( Scene::WINDOW_SIZE | Scene::MOUSE_PRESSED, boost::bind(&cairoApp::buildBrows, this, _1) );
+	scene.add( Scene::WINDOW_SIZE, boost::bind(&cairoApp::buildMouth, this, _1) );
 }
 
 void cairoApp::update()
 {
+	TRACE_ZONE("update");
+	if( scene.isDamaged() ) {
+		idleFrames = 0;
+	} else if( ++idleFrames == IDLE_FRAMES ) {
+		setFrameRate( IDLE_FRAME_RATE );
+	}
 }
 
 void cairoApp::draw()
 {
-	cairo::Context ctx( cairo::createWindowSurface() );     
-	ctx.setSource( Colorf(0,0,0) );
-	ctx.paint();
-	
-	Vec2f center = Vec2f( getWindowWidth()/2, getWindowHeight()/2 );
-	Vec2f offset = mouseLocation - center;
-	float length = offset.length();
-	offset.safeNormalize();
-	offset *= length/getWindowWidth() * 10;
-	
-	//Square
-	ctx.rectangle(center.x - 100, center.y - 100, 200.0, 200.0 );
-	ctx.setSource( Colorf(1,1,0) );
-	ctx.fillPreserve();
-	ctx.setSource( Colorf(1.0, 0.5, 0) );
-	ctx.setLineWidth( 5.0 );
-	ctx.stroke();
+	TRACE_ZONE("draw");
+	if( getWindowSize() != windowSize ) {
+		windowSize = getWindowSize();
+		scene.invalidate( Scene::WINDOW_SIZE );
+		scene.damage( Rectf(0, 0, windowSize.x, windowSize.y) );
+	}
 	
-	//Circles
-	ctx.circle( center + Vec2f(-30,-20), 20.0 );
-	ctx.circle( center + Vec2f(30,-20), 20.0 );
+	cairo::Context &ctx = buffers.begin( windowSize.x, windowSize.y );
+	scene.repaint( ctx, Colorf(0,0,0) );
+	buffers.present();
+}
+
+Vec2f cairoApp::getCenter()
+{
+	return Vec2f( getWindowWidth()/2, getWindowHeight()/2 );
+}
+
+static void addCircle(Shape2d &path, Vec2f center, float radius)
+{
+	path.moveTo( center + Vec2f(radius, 0) );
+	path.arc( center, radius, 0, M_PI * 2 );
+	path.close();
+}
+
+static void addArc(Shape2d &path, Vec2f center, float radius, float startAngle, float endAngle)
+{
+	path.moveTo( center + Vec2f(cos(startAngle), sin(startAngle)) * radius );
+	path.arc( center, radius, startAngle, endAngle );
+}
+
+//Square
+void cairoApp::buildSquare(SceneNode &node)
+{
+	Vec2f center = getCenter();
+	node.mPath.moveTo( center + Vec2f(-100,-100) );
+	node.mPath.lineTo( center + Vec2f(100,-100) );
+	node.mPath.lineTo( center + Vec2f(100,100) );
+	node.mPath.lineTo( center + Vec2f(-100,100) );
+	node.mPath.close();
+	node.mFill = true;
+	node.mFillColor = Colorf(1,1,0);
+	node.mLineWidth = 5.0;
+	node.mStrokeColor = Colorf(1.0, 0.5, 0);
+}
+
+//Circles
+void cairoApp::buildEyes(SceneNode &node)
+{
+	Vec2f center = getCenter();
+	addCircle( node.mPath, center + Vec2f(-30,-20), 20.0 );
+	addCircle( node.mPath, center + Vec2f(30,-20), 20.0 );
+	node.mFill = true;
 	if (mousePressed) {
-		ctx.setSource( Colorf(1,1,0) );
+		node.mFillColor = Colorf(1,1,0);
 	} else {
-		ctx.setSource( Colorf(1,1,1) );
+		node.mFillColor = Colorf(1,1,1);
 	}
-	ctx.fillPreserve();
-	ctx.setSource( Colorf(1.0, 0.5, 0) );
-	ctx.setLineWidth(1);
-	ctx.stroke();
-	
-	//More Circles
+	node.mLineWidth = 1;
+	node.mStrokeColor = Colorf(1.0, 0.5, 0);
+}
+
+//More Circles
+void cairoApp::buildPupils(SceneNode &node)
+{
+	Vec2f center = getCenter();
 	if (mousePressed) {
-		ctx.arc(center.x - 30, center.y - 20, 20, M_PI / 6, M_PI / 6 * 5);
-		ctx.setSource( Colorf(1.0,0.5,0) );
-		ctx.setLineWidth(5);
-		ctx.stroke();
-		ctx.arc(center.x + 30, center.y - 20, 20, M_PI / 6, M_PI / 6 * 5);
-		ctx.stroke();
+		addArc( node.mPath, center + Vec2f(-30,-20), 20, M_PI / 6, M_PI / 6 * 5 );
+		addArc( node.mPath, center + Vec2f(30,-20), 20, M_PI / 6, M_PI / 6 * 5 );
+		node.mLineWidth = 5;
+		node.mStrokeColor = Colorf(1.0,0.5,0);
 	} else {
-		ctx.circle( center + Vec2f(-30,-20) + offset, 7.0 );
-		ctx.circle( center + Vec2f(30,-20) + offset, 7.0 );
-		ctx.setSource( Colorf(0,0,1) );
-		ctx.fill();
+		Vec2f offset = mouseLocation - center;
+		float length = offset.length();
+		offset.safeNormalize();
+		offset *= length/getWindowWidth() * 10;
+		
+		addCircle( node.mPath, center + Vec2f(-30,-20) + offset, 7.0 );
+		addCircle( node.mPath, center + Vec2f(30,-20) + offset, 7.0 );
+		node.mFill = true;
+		node.mFillColor = Colorf(0,0,1);
 	}
-	
-	//Lines
+}
+
+//Lines
+void cairoApp::buildBrows(SceneNode &node)
+{
+	Vec2f center = getCenter();
 	if(mousePressed){
-		ctx.line( center + Vec2f(-55,-50), center + Vec2f(-20,-55) );
-		ctx.line( center + Vec2f(55,-50), center + Vec2f(20,-55) );
+		node.mPath.moveTo( center + Vec2f(-55,-50) );
+		node.mPath.lineTo( center + Vec2f(-20,-55) );
+		node.mPath.moveTo( center + Vec2f(55,-50) );
+		node.mPath.lineTo( center + Vec2f(20,-55) );
 	} else {
-		ctx.line( center + Vec2f(-55,-55), center + Vec2f(-20,-70) );
-		ctx.line( center + Vec2f(55,-55), center + Vec2f(20,-70) );
+		node.mPath.moveTo( center + Vec2f(-55,-55) );
+		node.mPath.lineTo( center + Vec2f(-20,-70) );
+		node.mPath.moveTo( center + Vec2f(55,-55) );
+		node.mPath.lineTo( center + Vec2f(20,-70) );
 	}
-	ctx.setLineWidth(3.0);
-	ctx.setSource( Colorf(1.0,0.5,0) );
-	ctx.stroke();
-	
-	//Arc
-	ctx.arc(center.x, center.y - 20, 80.0, M_PI / 4, M_PI / 4 * 3);
-	ctx.setLineWidth(8.0);
-	ctx.setSource( Colorf(1,0,0) );
-	ctx.stroke();
+	node.mLineWidth = 3.0;
+	node.mStrokeColor = Colorf(1.0,0.5,0);
+}
+
+//Arc
+void cairoApp::buildMouth(SceneNode &node)
+{
+	addArc( node.mPath, getCenter() + Vec2f(0,-20), 80.0, M_PI / 4, M_PI / 4 * 3 );
+	node.mLineWidth = 8.0;
+	node.mStrokeColor = Colorf(1,0,0);
 }
 
 CINDER_APP_BASIC( cairoApp, Renderer2d )
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "Scene.h"
+#include <cmath>
+
+static bool intersects(const Rectf &a, const Rectf &b)
+{
+	return a.x1 < b.x2 && b.x1 < a.x2 && a.y1 < b.y2 && b.y1 < a.y2;
+}
+
+SceneNode::SceneNode()
+	: mFill(false), mLineWidth(0), mInputs(0)
+{
+}
+
+void SceneNode::draw(cairo::Context &ctx) const
+{
+	ctx.newPath();
+	ctx.appendPath( mPath );
+	if( mFill ) {
+		ctx.setSource( mFillColor );
+		if( mLineWidth > 0 ) {
+			ctx.fillPreserve();
+		} else {
+			ctx.fill();
+		}
+	}
+	if( mLineWidth > 0 ) {
+		ctx.setSource( mStrokeColor );
+		ctx.setLineWidth( mLineWidth );
+		ctx.stroke();
+	}
+}
+
+void SceneNode::updateBounds()
+{
+	// a full line width covers miter joins at right angles; one more pixel for antialiasing
+	float margin = mLineWidth + 1.0f;
+	Rectf box = mPath.calcBoundingBox();
+	mBounds = Rectf( floor( box.x1 - margin ), floor( box.y1 - margin ), ceil( box.x2 + margin ), ceil( box.y2 + margin ) );
+}
+
+void Scene::add(uint32_t inputs, BuildFn build)
+{
+	SceneNode node;
+	node.mInputs = inputs;
+	build( node );
+	node.updateBounds();
+	damage( node.mBounds );
+	mNodes.push_back( node );
+	mBuilders.push_back( build );
+}
+
+void Scene::invalidate(uint32_t inputs)
+{
+	for( size_t i = 0; i < mNodes.size(); i++ ) {
+		if( ! ( mNodes[i].mInputs & inputs ) ) {
+			continue;
+		}
+		damage( mNodes[i].mBounds );
+		SceneNode node;
+		node.mInputs = mNodes[i].mInputs;
+		mBuilders[i]( node );
+		node.updateBounds();
+		damage( node.mBounds );
+		mNodes[i] = node;
+	}
+}
+
+void Scene::damage(const Rectf &rect)
+{
+	// merge into an overlapping rectangle, which keeps the list to a few entries
+	for( size_t i = 0; i < mDamage.size(); i++ ) {
+		if( intersects( mDamage[i], rect ) ) {
+			Rectf &merged = mDamage[i];
+			merged = Rectf( min( merged.x1, rect.x1 ), min( merged.y1, rect.y1 ), max( merged.x2, rect.x2 ), max( merged.y2, rect.y2 ) );
+			return;
+		}
+	}
+	mDamage.push_back( rect );
+}
+
+bool Scene::isDamaged() const
+{
+	return ! mDamage.empty() || ! mPreviousDamage.empty();
+}
+
+void Scene::repaint(cairo::Context &ctx, const Colorf &background)
+{
+	vector<Rectf> regions = mDamage;
+	regions.insert( regions.end(), mPreviousDamage.begin(), mPreviousDamage.end() );
+	mPreviousDamage = mDamage;
+	mDamage.clear();
+	if( regions.empty() ) {
+		return;
+	}
+	
+	ctx.save();
+	ctx.newPath();
+	for( size_t r = 0; r < regions.size(); r++ ) {
+		ctx.rectangle( regions[r].x1, regions[r].y1, regions[r].x2 - regions[r].x1, regions[r].y2 - regions[r].y1 );
+	}
+	ctx.clip();
+	ctx.setSource( background );
+	ctx.paint();
+	
+	for( size_t i = 0; i < mNodes.size(); i++ ) {
+		for( size_t r = 0; r < regions.size(); r++ ) {
+			if( intersects( mNodes[i].mBounds, regions[r] ) ) {
+				mNodes[i].draw( ctx );
+				break;
+			}
+		}
+	}
+	ctx.restore();
+}
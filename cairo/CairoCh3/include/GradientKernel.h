@@ -0,0 +1,18 @@
+#pragma once
+#include "cinder/Color.h"
+#include <stdint.h>
+
+using namespace ci;
+
+// Closed-form CPU version of the nested gradient tile drawGradient() builds
+// out of cairo fills. Ring k of a tile covers the square from k to tileSize - k,
+// and its gradient runs from c0 to c1 along one side, turning a quarter each
+// ring (left to right, top to bottom, right to left, bottom to top). So a
+// pixel's color only depends on its ring and its offset along the ring's gradient.
+// Pixels are written as cairo RGB24 words, four at a time with SSE2 where available.
+namespace GradientKernel {
+	// Writes one tileSize x tileSize tile, origin at the tile corner, into data
+	void renderTile(uint32_t *data, int stride, int tileSize, const Colorf &c0, const Colorf &c1);
+	// Fills a width x height buffer with tiles centered on multiples of tileSize, like the cairo version
+	void renderTiled(uint8_t *data, int stride, int width, int height, int tileSize, const Colorf &c0, const Colorf &c1);
+}
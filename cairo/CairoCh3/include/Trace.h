@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+
+using namespace std;
+
+// Scoped timing zones written out as a Chrome trace (chrome://tracing or
+// ui.perfetto.dev). Put TRACE_ZONE("name") at the top of a scope to record how
+// long it took. Zones only exist in builds with TRACE defined, such as the
+// Trace configuration or TRACE=1 ./benchmark.sh; otherwise the macro is empty
+// and costs nothing. Each thread records into its own ring buffer of the most
+// recent TRACE_RING_SIZE zones. Rings of finished threads are handed to the
+// next new thread, which keeps per-frame worker threads on a few lanes.
+// write() saves every ring to $TRACE_FILE, or trace.json by default; it runs
+// at exit, and the apps also call it when F1 is pressed.
+#define TRACE_RING_SIZE 16384
+
+#if defined( TRACE )
+	#define TRACE_ZONE( name ) TraceZone traceZone( name )
+#else
+	#define TRACE_ZONE( name )
+#endif
+
+class Trace {
+public:
+	// seconds since startup
+	static double now();
+	static void record(const char *name, double start, double end);
+	static void write();
+};
+
+class TraceZone {
+public:
+	TraceZone(const char *name) : mName(name), mStart(Trace::now()) {}
+	~TraceZone() { Trace::record(mName, mStart, Trace::now()); }
+	
+	const char *mName;
+	double mStart;
+};
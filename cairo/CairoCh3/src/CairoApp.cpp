@@ -1,51 +1,184 @@
-#include "cinder/app/AppBasic.h"
+#include "Headless.h"
 #include "cinder/cairo/cairo.h"
+#include "GradientKernel.h"
+#include "Trace.h"
+#include <cstdlib>
 using namespace ci;
 using namespace ci::app;
 using namespace std;
 
-class cairoApp : public AppBasic {
+class cairoApp : public AppBase {
 public:
+	cairoApp();
 	void setup();
 	void update();
 	void draw();
-	void drawGradient(Rectf rect);
+	void keyDown( KeyEvent event );
+	bool setOption(const string &name, const string &value);
+	void drawGradient(cairo::Context &target, Rectf rect, int count);
+	void renderTile();
+	void renderKernel();
+	void compareKernel();
 	cairo::Context ctx;
-	Rectf rect0;
-	int count;
 	float tileSize;
+	Colorf stopColor0, stopColor1;
+	
+	// one tile rendered offscreen and repeated across the window; rebuilt
+	// only when the tile size or gradient stops differ from the ones it was rendered with
+	cairo::SurfaceImage tileSurface;
+	cairo::PatternSurface tilePattern;
+	float patternTileSize;
+	Colorf patternColor0, patternColor1;
+	
+	// 'k' switches to the analytic kernel, which writes the whole window
+	// worth of tiles straight into kernelSurface instead of going through cairo
+	bool useKernel;
+	cairo::SurfaceImage kernelSurface;
+	bool kernelDirty;
 };
 
+static bool sameColor(const Colorf &a, const Colorf &b)
+{
+	return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+// defaults for what setOption() can change, which runs before setup()
+cairoApp::cairoApp()
+{
+	useKernel = false;
+}
+
 void cairoApp::setup()
 {	
-	ctx = cairo::Context( cairo::createWindowSurface() );
+	ctx = cairo::Context(createWindowSurface());
+	stopColor0 = Colorf(0.1, 0, 0.2);
+	stopColor1 = Colorf(1, 0, 1);
+	patternTileSize = 0;
+	kernelDirty = true;
 }
 
 void cairoApp::update()
 {
+	TRACE_ZONE("update");
 	tileSize = 32;
+	
+	if (tileSize != patternTileSize || ! sameColor(stopColor0, patternColor0) || ! sameColor(stopColor1, patternColor1)) {
+		renderTile();
+		kernelDirty = true;
+	}
+	
+	if (useKernel && (kernelDirty || kernelSurface.getWidth() != getWindowWidth() || kernelSurface.getHeight() != getWindowHeight())) {
+		renderKernel();
+	}
+}
+
+void cairoApp::keyDown( KeyEvent event )
+{
+	if( event.getCode() == KeyEvent::KEY_F1 ) {
+		Trace::write();
+		return;
+	}
+	if( event.getChar() == 'k' ){
+		useKernel = ! useKernel;
+		console() << ( useKernel ? "gradient kernel" : "cairo gradient" ) << endl;
+	}
+	if( event.getChar() == 'c' ){
+		compareKernel();
+	}
+}
+
+// headless benchmark options, see Headless.h
+bool cairoApp::setOption(const string &name, const string &value)
+{
+	if( name == "--kernel" ){
+		useKernel = atoi( value.c_str() ) != 0;
+		return true;
+	}
+	return false;
 }
 
 void cairoApp::draw()
 {
-	ctx.setSource( Colorf(0,0,0) );
+	TRACE_ZONE("draw");
+	if( useKernel ){
+		ctx.setSourceSurface( kernelSurface, 0, 0 );
+		ctx.paint();
+		return;
+	}
+	
+	// tiles are centered on multiples of tileSize, so the pattern starts half a tile up and left
+	ctx.save();
+	ctx.translate( -tileSize/2, -tileSize/2 );
+	ctx.setSource( tilePattern );
 	ctx.paint();
+	ctx.restore();
+}
+
+void cairoApp::renderTile()
+{
+	int size = ceil(tileSize);
+	tileSurface = cairo::SurfaceImage( size, size, false );
+	cairo::Context tileCtx( tileSurface );
+	tileCtx.setSource( Colorf(0,0,0) );
+	tileCtx.paint();
+	drawGradient( tileCtx, Rectf(0, 0, tileSize, tileSize), 0 );
 	
-	int tileCountX = ceil(getWindowWidth()/tileSize);
-	int tileCountY = ceil(getWindowHeight()/tileSize);
+	tilePattern = cairo::PatternSurface( tileSurface );
+	tilePattern.setExtendRepeat();
 	
-	for (int x = 0; x <= tileCountX; x++) {
-		for(int y = 0; y <= tileCountY; y++){
-			rect0 = Rectf(x*tileSize - tileSize/2, y*tileSize - tileSize/2, x*tileSize + tileSize/2, y*tileSize + tileSize/2);
-			count = 0;
-			drawGradient(rect0);
+	patternTileSize = tileSize;
+	patternColor0 = stopColor0;
+	patternColor1 = stopColor1;
+}
+
+void cairoApp::renderKernel()
+{
+	TRACE_ZONE("GradientKernel");
+	kernelSurface = cairo::SurfaceImage( getWindowWidth(), getWindowHeight(), false );
+	kernelSurface.flush();
+	GradientKernel::renderTiled( kernelSurface.getData(), kernelSurface.getStride(), kernelSurface.getWidth(), kernelSurface.getHeight(), ceil(tileSize), stopColor0, stopColor1 );
+	kernelSurface.markDirty();
+	kernelDirty = false;
+}
+
+// renders one tile both ways and reports how far apart they are, per channel in 0-255 steps
+void cairoApp::compareKernel()
+{
+	int size = ceil(tileSize);
+	cairo::SurfaceImage kernelTile( size, size, false );
+	kernelTile.flush();
+	GradientKernel::renderTile( (uint32_t*)kernelTile.getData(), kernelTile.getStride(), size, stopColor0, stopColor1 );
+	kernelTile.markDirty();
+	tileSurface.flush();
+	
+	int maxDiff = 0;
+	int mismatched = 0;
+	double total = 0;
+	for( int y = 0; y < size; y++ ){
+		const uint32_t *a = (const uint32_t*)( tileSurface.getData() + y * tileSurface.getStride() );
+		const uint32_t *b = (const uint32_t*)( kernelTile.getData() + y * kernelTile.getStride() );
+		for( int x = 0; x < size; x++ ){
+			int pixelDiff = 0;
+			for( int shift = 0; shift < 24; shift += 8 ){
+				int diff = abs( (int)( ( a[x] >> shift ) & 0xff ) - (int)( ( b[x] >> shift ) & 0xff ) );
+				pixelDiff = max( pixelDiff, diff );
+				total += diff;
+			}
+			maxDiff = max( maxDiff, pixelDiff );
+			if( pixelDiff > 1 ){
+				mismatched++;
+			}
 		}
 	}
+	
+	console() << "kernel vs cairo tile " << size << "x" << size << ": max diff " << maxDiff
+		<< ", mean diff " << total / ( size * size * 3 ) << ", " << mismatched << " pixels off by more than 1" << endl;
 }
 
-void cairoApp::drawGradient(Rectf rect)
+void cairoApp::drawGradient(cairo::Context &target, Rectf rect, int count)
 {
-	ctx.rectangle( rect.x1, rect.y1, rect.x2 - rect.x1, rect.y2 - rect.y1 );
+	TRACE_ZONE("drawGradient");
+	target.rectangle( rect.x1, rect.y1, rect.x2 - rect.x1, rect.y2 - rect.y1 );
 	cairo::GradientLinear gradient( Vec2f( rect.x1, rect.y1 ), Vec2f( rect.x2, rect.y1 ) );
 	if(count % 4 == 1){
 		gradient = cairo::GradientLinear( Vec2f( rect.x2, rect.y1 ), Vec2f( rect.x2, rect.y2 ) );
@@ -56,18 +189,17 @@ void cairoApp::drawGradient(Rectf rect)
 	if(count % 4 == 3){
 		gradient = cairo::GradientLinear( Vec2f( rect.x1, rect.y2 ), Vec2f( rect.x1, rect.y1 ) );
 	}
-	gradient.addColorStop(0, Colorf(0.1, 0, 0.2) );
-	gradient.addColorStop(1, Colorf(1, 0, 1) );
-	ctx.setSource(gradient);
-	ctx.fill();
+	gradient.addColorStop(0, stopColor0 );
+	gradient.addColorStop(1, stopColor1 );
+	target.setSource(gradient);
+	target.fill();
 	rect.x1 += 1;
 	rect.y1 += 1;
 	rect.x2 -= 1;
 	rect.y2 -= 1;
 	if(rect.x2 - rect.x1 > 1 && rect.y2 - rect.y1 > 1){
-		count++;
-		drawGradient(rect);
+		drawGradient(target, rect, count + 1);
 	}
 }
 
-CINDER_APP_BASIC( cairoApp, Renderer2d )
+CINDER_APP( cairoApp, Renderer2d )
@@ -0,0 +1,116 @@
+#include "GradientKernel.h"
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#if defined( __SSE2__ ) || defined( _M_IX86 ) || defined( _M_X64 )
+	#define GRADIENT_KERNEL_SSE2
+	#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+static uint32_t packPixel(float r, float g, float b)
+{
+	return ( uint32_t( r * 255.0f + 0.5f ) << 16 ) | ( uint32_t( g * 255.0f + 0.5f ) << 8 ) | uint32_t( b * 255.0f + 0.5f );
+}
+
+static uint32_t shadePixel(int x, int y, int tileSize, int lastRing, const Colorf &c0, const Colorf &c1)
+{
+	int ring = min( min( x, tileSize - 1 - x ), min( y, tileSize - 1 - y ) );
+	ring = min( ring, lastRing );
+	float size = tileSize - 2 * ring;
+	float cx = x + 0.5f;
+	float cy = y + 0.5f;
+	
+	float t;
+	switch( ring % 4 ){
+		case 0: t = ( cx - ring ) / size; break;
+		case 1: t = ( cy - ring ) / size; break;
+		case 2: t = ( tileSize - ring - cx ) / size; break;
+		default: t = ( tileSize - ring - cy ) / size; break;
+	}
+	
+	return packPixel( c0.r + ( c1.r - c0.r ) * t, c0.g + ( c1.g - c0.g ) * t, c0.b + ( c1.b - c0.b ) * t );
+}
+
+void GradientKernel::renderTile(uint32_t *data, int stride, int tileSize, const Colorf &c0, const Colorf &c1)
+{
+	// drawGradient stops once a ring would be 1 pixel or less across
+	int lastRing = max( ( tileSize - 2 ) / 2, 0 );
+	
+	for( int y = 0; y < tileSize; y++ ){
+		uint32_t *row = (uint32_t*)( (uint8_t*)data + y * stride );
+		int x = 0;
+		
+#if defined( GRADIENT_KERNEL_SSE2 )
+		const __m128 one = _mm_set1_ps( 1.0f );
+		const __m128 half = _mm_set1_ps( 0.5f );
+		const __m128 scale = _mm_set1_ps( 255.0f );
+		const __m128 tile = _mm_set1_ps( (float)tileSize );
+		const __m128 last = _mm_set1_ps( (float)lastRing );
+		const __m128 yEdge = _mm_set1_ps( (float)min( y, tileSize - 1 - y ) );
+		const __m128 cy = _mm_set1_ps( y + 0.5f );
+		const __m128 r0 = _mm_set1_ps( c0.r ), dr = _mm_set1_ps( c1.r - c0.r );
+		const __m128 g0 = _mm_set1_ps( c0.g ), dg = _mm_set1_ps( c1.g - c0.g );
+		const __m128 b0 = _mm_set1_ps( c0.b ), db = _mm_set1_ps( c1.b - c0.b );
+		
+		for( ; x + 4 <= tileSize; x += 4 ){
+			__m128 px = _mm_set_ps( x + 3.0f, x + 2.0f, x + 1.0f, (float)x );
+			__m128 cx = _mm_add_ps( px, half );
+			__m128 xEdge = _mm_min_ps( px, _mm_sub_ps( _mm_sub_ps( tile, one ), px ) );
+			__m128 ring = _mm_min_ps( _mm_min_ps( xEdge, yEdge ), last );
+			__m128 size = _mm_sub_ps( tile, _mm_add_ps( ring, ring ) );
+			
+			// ring % 4 picks the gradient direction
+			__m128i ringInt = _mm_cvttps_epi32( ring );
+			__m128i direction = _mm_and_si128( ringInt, _mm_set1_epi32( 3 ) );
+			__m128 is1 = _mm_castsi128_ps( _mm_cmpeq_epi32( direction, _mm_set1_epi32( 1 ) ) );
+			__m128 is2 = _mm_castsi128_ps( _mm_cmpeq_epi32( direction, _mm_set1_epi32( 2 ) ) );
+			__m128 is3 = _mm_castsi128_ps( _mm_cmpeq_epi32( direction, _mm_set1_epi32( 3 ) ) );
+			
+			__m128 far = _mm_sub_ps( tile, ring );
+			__m128 t = _mm_sub_ps( cx, ring );
+			t = _mm_or_ps( _mm_andnot_ps( is1, t ), _mm_and_ps( is1, _mm_sub_ps( cy, ring ) ) );
+			t = _mm_or_ps( _mm_andnot_ps( is2, t ), _mm_and_ps( is2, _mm_sub_ps( far, cx ) ) );
+			t = _mm_or_ps( _mm_andnot_ps( is3, t ), _mm_and_ps( is3, _mm_sub_ps( far, cy ) ) );
+			t = _mm_div_ps( t, size );
+			
+			__m128i r = _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( _mm_add_ps( r0, _mm_mul_ps( dr, t ) ), scale ), half ) );
+			__m128i g = _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( _mm_add_ps( g0, _mm_mul_ps( dg, t ) ), scale ), half ) );
+			__m128i b = _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( _mm_add_ps( b0, _mm_mul_ps( db, t ) ), scale ), half ) );
+			__m128i pixels = _mm_or_si128( _mm_or_si128( _mm_slli_epi32( r, 16 ), _mm_slli_epi32( g, 8 ) ), b );
+			_mm_storeu_si128( (__m128i*)( row + x ), pixels );
+		}
+#endif
+		
+		for( ; x < tileSize; x++ ){
+			row[x] = shadePixel( x, y, tileSize, lastRing, c0, c1 );
+		}
+	}
+}
+
+void GradientKernel::renderTiled(uint8_t *data, int stride, int width, int height, int tileSize, const Colorf &c0, const Colorf &c1)
+{
+	if( tileSize < 1 ){
+		return;
+	}
+	
+	vector<uint32_t> tile( tileSize * tileSize );
+	renderTile( &tile[0], tileSize * 4, tileSize, c0, c1 );
+	
+	// window pixel (x, y) is tile pixel ((x + tileSize/2) % tileSize, (y + tileSize/2) % tileSize)
+	int offset = tileSize / 2;
+	for( int y = 0; y < height; y++ ){
+		const uint32_t *tileRow = &tile[( ( y + offset ) % tileSize ) * tileSize];
+		uint32_t *row = (uint32_t*)( data + y * stride );
+		int x = 0;
+		int tx = offset % tileSize;
+		while( x < width ){
+			int run = min( tileSize - tx, width - x );
+			memcpy( row + x, tileRow + tx, run * 4 );
+			x += run;
+			tx = 0;
+		}
+	}
+}
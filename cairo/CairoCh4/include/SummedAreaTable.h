@@ -0,0 +1,31 @@
+#pragma once
+#include "cinder/Area.h"
+#include "PlanarImage.h"
+#include <vector>
+#include <stdint.h>
+
+using namespace ci;
+using namespace std;
+
+// Integral image of a PlanarImage. Every entry holds the running red, green
+// and blue totals of all the pixels above and to the left of it, so the mean
+// color of any rectangle costs four lookups no matter how big the rectangle is.
+// The totals are 32-bit and allowed to wrap: the four-lookup difference comes
+// out exact modulo 2^32, which is exact for any rectangle of up to 2^24 pixels,
+// far more than a mosaic cell. That is 12 bytes per pixel instead of 24 for
+// doubles, on top of the 3 of the planar image.
+class SummedAreaTable {
+public:
+	SummedAreaTable();
+	
+	// Rebuilds the table, but only when image is not the image we already hold
+	void setSource( const PlanarImage &image );
+	// Mean color of the pixels inside area, clipped to the source bounds
+	Colorf getAverage( Area area ) const;
+	// Bytes held by the table itself
+	size_t getMemorySize() const { return mSums.size() * sizeof(uint32_t); }
+	
+	PlanarImage mSource;
+	int mWidth, mHeight;
+	vector<uint32_t> mSums;
+};
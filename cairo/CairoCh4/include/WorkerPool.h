@@ -0,0 +1,49 @@
+#pragma once
+#include <boost/thread.hpp>
+#include <boost/function.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/noncopyable.hpp>
+#include <stdint.h>
+
+using namespace std;
+
+// Threads that stay up for the life of the app and run batches of numbered
+// tasks. run() deals the tasks out as one contiguous range per thread, the
+// calling thread included; a thread that finishes its range steals single
+// tasks from the far end of the others', so uneven tasks still balance out.
+// run() returns once every task of the batch is done.
+class WorkerPool : private boost::noncopyable {
+public:
+	typedef boost::function<void (size_t)> TaskFn;
+	
+	// threadCount 0 picks one thread per hardware thread
+	WorkerPool(int threadCount = 0);
+	~WorkerPool();
+	
+	// Calls task(0) to task(count - 1), spread across the pool
+	void run(size_t count, TaskFn task);
+	int getThreadCount() const { return mThreadCount; }
+	
+	void loop(int worker);
+	void work(int worker);
+	// Next task for worker, from its own range or stolen; false once there are none left
+	bool take(int worker, size_t &task);
+	
+	struct Range {
+		boost::mutex mMutex;
+		size_t mBegin, mEnd;
+	};
+	
+	int mThreadCount;
+	boost::scoped_array<Range> mRanges;
+	TaskFn mTask;
+	
+	boost::mutex mMutex;
+	boost::condition_variable mStart, mDone;
+	// bumped for every batch, so sleeping workers can tell a new batch from a spurious wakeup
+	uint32_t mBatch;
+	// workers still busy with the current batch
+	int mBusy;
+	bool mQuit;
+	boost::thread_group mThreads;
+};
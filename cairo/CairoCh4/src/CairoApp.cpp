@@ -1,28 +1,59 @@
-#include "cinder/app/AppBasic.h"
+#include "Headless.h"
 #include "cinder/cairo/Cairo.h"
 #include "cinder/ImageIo.h"
+#include "SummedAreaTable.h"
+#include "BandRenderer.h"
+#include "TiledImage.h"
+#include "Trace.h"
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
 
 using namespace ci;
 using namespace ci::app;
 using namespace std;
 
 
-class cairoApp : public AppBasic {
+class cairoApp : public AppBase {
 public:
+	cairoApp();
 	void setup();
 	void update();
 	void draw();
-	Colorf getColor(Surface32f surface, Vec2i pixel);
+	void drawCells(cairo::Context &target, Area area);
+	void drawBucketed(cairo::Context &target, Area area);
+	Colorf getColor(Vec2i pixel);
 	void keyDown(KeyEvent event);
+	bool setOption(const string &name, const string &value);
 	
 	cairo::Context ctx;
-	Surface32f surface;
+	PlanarImage image;
+	SummedAreaTable table;
 	
 	int cellSize;
+	
+	// levels per channel of the palette cells are bucketed into; 0 fills every cell in its exact color
+	int paletteLevels;
+	
+	BandRenderer bands;
+	bool useBands;
+	
+	// an out-of-core tile set replacing sunset.png once opened, panned with the arrow keys
+	boost::shared_ptr<TiledImage> tiles;
+	Vec2i viewOffset;
 };
 
+// the most decoded tile data kept in memory at once
+static const size_t TILE_MEMORY_BUDGET = 256 * 1024 * 1024;
+
 void cairoApp::keyDown(KeyEvent event)
 {
+	if( event.getCode() == KeyEvent::KEY_F1 ) {
+		Trace::write();
+		return;
+	}
 	if( event.getChar() == '1' ) {
 		cellSize *= 0.667f;
 	} else if (event.getChar()== '2') {
@@ -35,62 +66,167 @@ void cairoApp::keyDown(KeyEvent event)
 	if (cellSize > getWindowWidth()){
 		cellSize = getWindowWidth();
 	}
-}
-
-Colorf cairoApp::getColor( Surface32f surface, Vec2i pixel){
 	
-	Vec2i UL = Vec2i(pixel.x, pixel.y);
-	Vec2i LR = Vec2i(pixel.x + cellSize, pixel.y + cellSize );
-	int totalPixels = 0;
-	float rTotal = 0.0f;
-	float gTotal = 0.0f;
-	float bTotal = 0.0f;
+	// 'q' toggles between exact and bucketed fills, '[' and ']' change the palette size
+	if( event.getChar() == 'q' ) {
+		paletteLevels = paletteLevels > 0 ? 0 : 8;
+	} else if( event.getChar() == '[' && paletteLevels > 2 ) {
+		paletteLevels /= 2;
+	} else if( event.getChar() == ']' && paletteLevels > 0 && paletteLevels < 64 ) {
+		paletteLevels *= 2;
+	}
+	
+	// 'p' switches between banded rendering on all cores and the main thread only
+	if( event.getChar() == 'p' ) {
+		useBands = ! useBands;
+	}
 	
-	for(int x = int(UL.x); x <= int(LR.x); x++){
-		
-		for(int y = int(UL.y); y <= int(LR.y); y++){
-			
-			Vec2i currentPixel = Vec2i(x,y);
-			float r = *surface.getDataRed(currentPixel);
-			float g = *surface.getDataGreen(currentPixel);
-			float b = *surface.getDataBlue(currentPixel);
-			
-			rTotal += r;
-			gTotal += g;
-			bTotal += b;
-			totalPixels++;
+	// 't' opens a tile set directory, 'w' cuts sunset.png into one to try it with
+	if( event.getChar() == 't' ) {
+		string directory = getFolderPath();
+		if( ! directory.empty() ) {
+			tiles = boost::shared_ptr<TiledImage>( new TiledImage(directory, TILE_MEMORY_BUDGET) );
+			viewOffset = Vec2i(0, 0);
+		}
+	} else if( event.getChar() == 'w' ) {
+		string directory = getFolderPath();
+		if( ! directory.empty() ) {
+			TiledImage::writeTiles( Surface32f( loadImage( loadResource("sunset.png") ) ), directory, 128 );
 		}
 	}
 	
-	float r = rTotal / totalPixels;
-	float g = gTotal / totalPixels;
-	float b = bTotal / totalPixels;
+	if( tiles ) {
+		Vec2i step = Vec2i(getWindowWidth() / 2, getWindowHeight() / 2);
+		if( event.getCode() == KeyEvent::KEY_LEFT ) {
+			viewOffset.x = max(viewOffset.x - step.x, 0);
+		} else if( event.getCode() == KeyEvent::KEY_RIGHT ) {
+			viewOffset.x = min(viewOffset.x + step.x, max(tiles->mWidth - getWindowWidth(), 0));
+		} else if( event.getCode() == KeyEvent::KEY_UP ) {
+			viewOffset.y = max(viewOffset.y - step.y, 0);
+		} else if( event.getCode() == KeyEvent::KEY_DOWN ) {
+			viewOffset.y = min(viewOffset.y + step.y, max(tiles->mHeight - getWindowHeight(), 0));
+		}
+	}
+}
+
+// headless benchmark options, see Headless.h
+bool cairoApp::setOption(const string &name, const string &value)
+{
+	if( name == "--cell-size" ) {
+		cellSize = max(atoi(value.c_str()), 2);
+	} else if( name == "--palette" ) {
+		paletteLevels = atoi(value.c_str());
+	} else if( name == "--bands" ) {
+		useBands = atoi(value.c_str()) != 0;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+Colorf cairoApp::getColor(Vec2i pixel){
 	
-	return Colorf( r, g, b );
+	// the cell covers pixel through pixel + cellSize inclusive
+	Area cell = Area(pixel.x, pixel.y, pixel.x + cellSize + 1, pixel.y + cellSize + 1);
+	if( tiles ) {
+		Vec2i UL = pixel + viewOffset;
+		return tiles->getMean( Area(UL.x, UL.y, UL.x + cellSize + 1, UL.y + cellSize + 1) );
+	}
+	return table.getAverage(cell);
 }
 
-void cairoApp::setup()
+// defaults for what setOption() can change, which runs before setup()
+cairoApp::cairoApp()
 {
-	ctx = cairo::Context(cairo::createWindowSurface());
-	surface = Surface32f( loadImage( loadResource("sunset.png") ) );
 	cellSize = 10;
+	paletteLevels = 0;
+	useBands = true;
+}
+
+void cairoApp::setup()
+{
+	ctx = cairo::Context(createWindowSurface());
+	image = PlanarImage( Surface32f( loadImage( loadResource("sunset.png") ) ) );
+	table.setSource(image);
 }
 
 void cairoApp::update()
 {
+	TRACE_ZONE("update");
 }
 
 void cairoApp::draw()
 {
-	for (int x = 0; x < getWindowWidth(); x+=cellSize) {
-		for (int y = 0; y < getWindowHeight(); y+=cellSize) {
+	TRACE_ZONE("draw");
+	if (tiles) {
+		tiles->prefetch( Area(viewOffset.x, viewOffset.y, viewOffset.x + getWindowWidth(), viewOffset.y + getWindowHeight()) );
+	}
+	
+	if (useBands) {
+		bands.render(ctx, getWindowWidth(), getWindowHeight(), boost::bind(&cairoApp::drawCells, this, _1, _2));
+	} else {
+		drawCells(ctx, getWindowBounds());
+	}
+}
+
+// Draws every cell that overlaps area. Called from several band threads at
+// once, so it only reads the image and settings.
+void cairoApp::drawCells(cairo::Context &target, Area area)
+{
+	TRACE_ZONE("drawCells");
+	if (paletteLevels > 0) {
+		drawBucketed(target, area);
+		return;
+	}
+	
+	for (int x = 0; x < area.x2; x+=cellSize) {
+		for (int y = area.y1 / cellSize * cellSize; y < area.y2; y+=cellSize) {
 			Vec2i pixel = Vec2i(x,y);
-			Colorf color = getColor(surface, pixel);
-			ctx.rectangle(x,y,cellSize,cellSize);
-			ctx.setSource(color);
-			ctx.fill();
+			Colorf color = getColor(pixel);
+			target.rectangle(x,y,cellSize,cellSize);
+			target.setSource(color);
+			target.fill();
+		}
+	}
+}
+
+static bool compareBuckets( const pair<int, Vec2i> &a, const pair<int, Vec2i> &b )
+{
+	return a.first < b.first;
+}
+
+// Quantizes every cell color to a paletteLevels^3 palette and collects the
+// cells of each palette entry into one path, so the frame costs one fill per
+// color in use instead of one per cell. Each bucket is filled with the color
+// at the center of its palette entry, so neighbouring bands agree.
+void cairoApp::drawBucketed(cairo::Context &target, Area area)
+{
+	vector< pair<int, Vec2i> > cells;
+	for (int x = 0; x < area.x2; x+=cellSize) {
+		for (int y = area.y1 / cellSize * cellSize; y < area.y2; y+=cellSize) {
+			Vec2i pixel = Vec2i(x,y);
+			Colorf color = getColor(pixel);
+			int r = min( int(color.r * paletteLevels), paletteLevels - 1 );
+			int g = min( int(color.g * paletteLevels), paletteLevels - 1 );
+			int b = min( int(color.b * paletteLevels), paletteLevels - 1 );
+			cells.push_back( make_pair( ( r * paletteLevels + g ) * paletteLevels + b, pixel ) );
+		}
+	}
+	
+	// sorting by bucket puts each palette entry's cells next to each other
+	sort( cells.begin(), cells.end(), compareBuckets );
+	
+	for (size_t i = 0; i < cells.size(); ) {
+		int bucket = cells[i].first;
+		for ( ; i < cells.size() && cells[i].first == bucket; i++) {
+			target.rectangle(cells[i].second.x, cells[i].second.y, cellSize, cellSize);
 		}
+		float r = ( bucket / ( paletteLevels * paletteLevels ) + 0.5f ) / paletteLevels;
+		float g = ( bucket / paletteLevels % paletteLevels + 0.5f ) / paletteLevels;
+		float b = ( bucket % paletteLevels + 0.5f ) / paletteLevels;
+		target.setSource(Colorf(r, g, b));
+		target.fill();
 	}
 }
 
-CINDER_APP_BASIC( cairoApp, Renderer2d )
\ No newline at end of file
+CINDER_APP( cairoApp, Renderer2d )
\ No newline at end of file
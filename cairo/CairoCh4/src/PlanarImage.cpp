@@ -0,0 +1,143 @@
+#include "PlanarImage.h"
+
+#if defined( __SSE2__ ) || defined( _M_IX86 ) || defined( _M_X64 )
+	#define PLANAR_IMAGE_SSE2
+	#include <emmintrin.h>
+#endif
+#if defined( __AVX2__ )
+	#include <immintrin.h>
+#endif
+#include <cstdlib>
+
+static const int ROW_ALIGNMENT = 32;
+
+static uint8_t* allocateAligned(size_t bytes)
+{
+#if defined( PLANAR_IMAGE_SSE2 )
+	return (uint8_t*)_mm_malloc( bytes, ROW_ALIGNMENT );
+#else
+	return (uint8_t*)malloc( bytes );
+#endif
+}
+
+static void freeAligned(uint8_t *data)
+{
+#if defined( PLANAR_IMAGE_SSE2 )
+	_mm_free( data );
+#else
+	free( data );
+#endif
+}
+
+// Sum of row[x1] through row[x2 - 1]. The middle of the span is summed 16 or
+// 32 bytes at a time with psadbw against zero, which adds 8 bytes into one
+// 64-bit lane per instruction; the unaligned ends are summed one by one.
+static uint32_t sumRow(const uint8_t *row, int x1, int x2)
+{
+	uint32_t sum = 0;
+	int x = x1;
+	
+#if defined( PLANAR_IMAGE_SSE2 )
+	while( x < x2 && ( (size_t)( row + x ) & 15 ) != 0 ){
+		sum += row[x++];
+	}
+	
+	__m128i zero = _mm_setzero_si128();
+	__m128i total = _mm_setzero_si128();
+#if defined( __AVX2__ )
+	if( x + 32 <= x2 && ( (size_t)( row + x ) & 31 ) != 0 ){
+		total = _mm_add_epi64( total, _mm_sad_epu8( _mm_load_si128( (const __m128i*)( row + x ) ), zero ) );
+		x += 16;
+	}
+	__m256i zero256 = _mm256_setzero_si256();
+	__m256i total256 = _mm256_setzero_si256();
+	for( ; x + 32 <= x2; x += 32 ){
+		total256 = _mm256_add_epi64( total256, _mm256_sad_epu8( _mm256_load_si256( (const __m256i*)( row + x ) ), zero256 ) );
+	}
+	total = _mm_add_epi64( total, _mm256_castsi256_si128( total256 ) );
+	total = _mm_add_epi64( total, _mm256_extracti128_si256( total256, 1 ) );
+#endif
+	for( ; x + 16 <= x2; x += 16 ){
+		total = _mm_add_epi64( total, _mm_sad_epu8( _mm_load_si128( (const __m128i*)( row + x ) ), zero ) );
+	}
+	sum += _mm_cvtsi128_si32( total ) + _mm_cvtsi128_si32( _mm_srli_si128( total, 8 ) );
+#endif
+	
+	while( x < x2 ){
+		sum += row[x++];
+	}
+	return sum;
+}
+
+PlanarImage::PlanarImage()
+{
+	mWidth = 0;
+	mHeight = 0;
+	mRowBytes = 0;
+}
+
+PlanarImage::PlanarImage(int width, int height)
+{
+	mWidth = width;
+	mHeight = height;
+	mRowBytes = ( width + ROW_ALIGNMENT - 1 ) / ROW_ALIGNMENT * ROW_ALIGNMENT;
+	mData = boost::shared_ptr<uint8_t>( allocateAligned( getMemorySize() ), freeAligned );
+}
+
+PlanarImage::PlanarImage(Surface32f surface)
+{
+	*this = PlanarImage( surface.getWidth(), surface.getHeight() );
+	
+	Surface32f::Iter iter = surface.getIter();
+	while( iter.line() ){
+		uint8_t *red = getRow( 0, iter.y() );
+		uint8_t *green = getRow( 1, iter.y() );
+		uint8_t *blue = getRow( 2, iter.y() );
+		while( iter.pixel() ){
+			red[iter.x()] = (uint8_t)( math<float>::clamp( iter.r() ) * 255.0f + 0.5f );
+			green[iter.x()] = (uint8_t)( math<float>::clamp( iter.g() ) * 255.0f + 0.5f );
+			blue[iter.x()] = (uint8_t)( math<float>::clamp( iter.b() ) * 255.0f + 0.5f );
+		}
+	}
+}
+
+uint8_t* PlanarImage::getRow(int channel, int y)
+{
+	return mData.get() + ( channel * mHeight + y ) * mRowBytes;
+}
+
+const uint8_t* PlanarImage::getRow(int channel, int y) const
+{
+	return mData.get() + ( channel * mHeight + y ) * mRowBytes;
+}
+
+uint64_t PlanarImage::getSum(int channel, Area area) const
+{
+	area.clipBy( Area( 0, 0, mWidth, mHeight ) );
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 ){
+		return 0;
+	}
+	
+	uint64_t sum = 0;
+	for( int y = area.y1; y < area.y2; y++ ){
+		sum += sumRow( getRow( channel, y ), area.x1, area.x2 );
+	}
+	return sum;
+}
+
+Colorf PlanarImage::getMean(Area area) const
+{
+	area.clipBy( Area( 0, 0, mWidth, mHeight ) );
+	int totalPixels = area.getWidth() * area.getHeight();
+	if( totalPixels <= 0 ){
+		return Colorf( 0, 0, 0 );
+	}
+	
+	float scale = 1.0f / ( totalPixels * 255.0f );
+	return Colorf( getSum( 0, area ) * scale, getSum( 1, area ) * scale, getSum( 2, area ) * scale );
+}
+
+size_t PlanarImage::getMemorySize() const
+{
+	return (size_t)mRowBytes * mHeight * 3;
+}
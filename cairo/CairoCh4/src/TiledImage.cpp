@@ -0,0 +1,233 @@
+#include "TiledImage.h"
+#include "cinder/ImageIo.h"
+#include <boost/bind.hpp>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+static string tilePath(const string &directory, int column, int row)
+{
+	stringstream path;
+	path << directory << "/tile_" << column << "_" << row << ".png";
+	return path.str();
+}
+
+TiledImage::TiledImage(const string &directory, size_t memoryBudget)
+{
+	mDirectory = directory;
+	mWidth = 0;
+	mHeight = 0;
+	mTileSize = 256;
+	mBudget = memoryBudget;
+	mBytes = 0;
+	mQuit = false;
+	
+	ifstream manifest( ( directory + "/tiles.txt" ).c_str() );
+	manifest >> mWidth >> mHeight >> mTileSize;
+	if( mTileSize < 1 ){
+		mTileSize = 256;
+	}
+	mColumns = ( mWidth + mTileSize - 1 ) / mTileSize;
+	mRows = ( mHeight + mTileSize - 1 ) / mTileSize;
+	
+	mPrefetcher = boost::thread( boost::bind( &TiledImage::prefetchLoop, this ) );
+}
+
+TiledImage::~TiledImage()
+{
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		mQuit = true;
+	}
+	mWake.notify_all();
+	mPrefetcher.join();
+}
+
+void TiledImage::writeTiles(Surface32f surface, const string &directory, int tileSize)
+{
+	ofstream manifest( ( directory + "/tiles.txt" ).c_str() );
+	manifest << surface.getWidth() << " " << surface.getHeight() << " " << tileSize << endl;
+	
+	for( int y = 0; y < surface.getHeight(); y += tileSize ){
+		for( int x = 0; x < surface.getWidth(); x += tileSize ){
+			Area area = Area( x, y, x + tileSize, y + tileSize );
+			area.clipBy( surface.getBounds() );
+			Surface8u tile( area.getWidth(), area.getHeight(), false );
+			Surface32f::Iter iter = surface.getIter( area );
+			while( iter.line() ){
+				while( iter.pixel() ){
+					Vec2i pixel = Vec2i( iter.x() - x, iter.y() - y );
+					*tile.getDataRed( pixel ) = (uint8_t)( math<float>::clamp( iter.r() ) * 255.0f + 0.5f );
+					*tile.getDataGreen( pixel ) = (uint8_t)( math<float>::clamp( iter.g() ) * 255.0f + 0.5f );
+					*tile.getDataBlue( pixel ) = (uint8_t)( math<float>::clamp( iter.b() ) * 255.0f + 0.5f );
+				}
+			}
+			writeImage( tilePath( directory, x / tileSize, y / tileSize ), tile );
+		}
+	}
+}
+
+PlanarImage TiledImage::getTile(int column, int row)
+{
+	int key = row * mColumns + column;
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		map< int, pair< PlanarImage, list<int>::iterator > >::iterator cached = mTiles.find(key);
+		if( cached != mTiles.end() ){
+			mRecent.splice( mRecent.begin(), mRecent, cached->second.second );
+			return cached->second.first;
+		}
+	}
+	
+	// decode without holding the lock; if another thread wins the race, insert keeps its copy
+	PlanarImage tile = loadTile(column, row);
+	insert(key, tile);
+	return tile;
+}
+
+Colorf TiledImage::getMean(Area area)
+{
+	area.clipBy( Area( 0, 0, mWidth, mHeight ) );
+	int totalPixels = area.getWidth() * area.getHeight();
+	if( totalPixels <= 0 ){
+		return Colorf( 0, 0, 0 );
+	}
+	
+	uint64_t sums[3] = { 0, 0, 0 };
+	for( int row = area.y1 / mTileSize; row <= ( area.y2 - 1 ) / mTileSize; row++ ){
+		for( int column = area.x1 / mTileSize; column <= ( area.x2 - 1 ) / mTileSize; column++ ){
+			PlanarImage tile = getTile(column, row);
+			Area local = Area( area.x1 - column * mTileSize, area.y1 - row * mTileSize, area.x2 - column * mTileSize, area.y2 - row * mTileSize );
+			for( int c = 0; c < 3; c++ ){
+				sums[c] += tile.getSum(c, local);
+			}
+		}
+	}
+	
+	float scale = 1.0f / ( totalPixels * 255.0f );
+	return Colorf( sums[0] * scale, sums[1] * scale, sums[2] * scale );
+}
+
+cairo::SurfaceImage TiledImage::getRegion(Area area)
+{
+	cairo::SurfaceImage region( max( area.getWidth(), 1 ), max( area.getHeight(), 1 ), false );
+	uint8_t *data = region.getData();
+	int stride = region.getStride();
+	memset( data, 0, stride * region.getHeight() );
+	
+	Area clipped = area;
+	clipped.clipBy( Area( 0, 0, mWidth, mHeight ) );
+	if( clipped.getWidth() <= 0 || clipped.getHeight() <= 0 ){
+		region.markDirty();
+		return region;
+	}
+	
+	for( int row = clipped.y1 / mTileSize; row <= ( clipped.y2 - 1 ) / mTileSize; row++ ){
+		for( int column = clipped.x1 / mTileSize; column <= ( clipped.x2 - 1 ) / mTileSize; column++ ){
+			PlanarImage tile = getTile(column, row);
+			int x1 = max( clipped.x1, column * mTileSize );
+			int x2 = min( clipped.x2, column * mTileSize + tile.mWidth );
+			int y1 = max( clipped.y1, row * mTileSize );
+			int y2 = min( clipped.y2, row * mTileSize + tile.mHeight );
+			for( int y = y1; y < y2; y++ ){
+				const uint8_t *red = tile.getRow( 0, y - row * mTileSize );
+				const uint8_t *green = tile.getRow( 1, y - row * mTileSize );
+				const uint8_t *blue = tile.getRow( 2, y - row * mTileSize );
+				uint32_t *pixels = (uint32_t*)( data + ( y - area.y1 ) * stride );
+				for( int x = x1; x < x2; x++ ){
+					int tx = x - column * mTileSize;
+					// cairo's RGB24 is one native-endian 32-bit word per pixel
+					pixels[x - area.x1] = 0xFF000000 | ( red[tx] << 16 ) | ( green[tx] << 8 ) | blue[tx];
+				}
+			}
+		}
+	}
+	
+	region.markDirty();
+	return region;
+}
+
+void TiledImage::prefetch(Area visible)
+{
+	int column1 = max( visible.x1 / mTileSize - 1, 0 );
+	int row1 = max( visible.y1 / mTileSize - 1, 0 );
+	int column2 = min( ( visible.x2 - 1 ) / mTileSize + 1, mColumns - 1 );
+	int row2 = min( ( visible.y2 - 1 ) / mTileSize + 1, mRows - 1 );
+	
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		mQueue.clear();
+		for( int row = row1; row <= row2; row++ ){
+			for( int column = column1; column <= column2; column++ ){
+				int key = row * mColumns + column;
+				if( mTiles.find(key) == mTiles.end() ){
+					mQueue.push_back(key);
+				}
+			}
+		}
+	}
+	mWake.notify_one();
+}
+
+bool TiledImage::isCached(int key)
+{
+	boost::mutex::scoped_lock lock(mMutex);
+	return mTiles.find(key) != mTiles.end();
+}
+
+PlanarImage TiledImage::loadTile(int column, int row)
+{
+	try {
+		return PlanarImage( Surface32f( loadImage( tilePath( mDirectory, column, row ) ) ) );
+	}
+	catch( ... ) {
+		// a missing or broken tile reads as black rather than taking the app down
+		int width = min( mTileSize, mWidth - column * mTileSize );
+		int height = min( mTileSize, mHeight - row * mTileSize );
+		PlanarImage blank( max( width, 1 ), max( height, 1 ) );
+		memset( blank.mData.get(), 0, blank.getMemorySize() );
+		return blank;
+	}
+}
+
+void TiledImage::insert(int key, PlanarImage tile)
+{
+	boost::mutex::scoped_lock lock(mMutex);
+	if( mTiles.find(key) != mTiles.end() ){
+		return;
+	}
+	
+	mRecent.push_front(key);
+	mTiles[key] = make_pair( tile, mRecent.begin() );
+	mBytes += tile.getMemorySize();
+	
+	// evict from the cold end, but never the tile just inserted
+	while( mBytes > mBudget && mRecent.size() > 1 ){
+		int coldest = mRecent.back();
+		mBytes -= mTiles[coldest].first.getMemorySize();
+		mTiles.erase(coldest);
+		mRecent.pop_back();
+	}
+}
+
+void TiledImage::prefetchLoop()
+{
+	while( true ){
+		int key;
+		{
+			boost::mutex::scoped_lock lock(mMutex);
+			while( ! mQuit && mQueue.empty() ){
+				mWake.wait(lock);
+			}
+			if( mQuit ){
+				return;
+			}
+			key = mQueue.front();
+			mQueue.pop_front();
+		}
+		
+		if( ! isCached(key) ){
+			insert( key, loadTile( key % mColumns, key / mColumns ) );
+		}
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "cinder/cairo/Cairo.h"
+#include "cinder/Area.h"
+#include "WorkerPool.h"
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+using namespace ci;
+using namespace std;
+
+// Splits the window into horizontal bands and draws every band on its own
+// pool thread into its own cairo image surface, then composites the bands into
+// the window context. The draw function gets a context that is already clipped to
+// the band and translated so window coordinates land in it, plus the band's
+// bounds so it can skip anything outside them. It runs on several threads at
+// once, so it must only read shared state.
+class BandRenderer : private boost::noncopyable {
+public:
+	typedef boost::function<void (cairo::Context&, Area)> DrawFn;
+	
+	// one band per pool thread; bandCount 0 picks one per hardware thread
+	BandRenderer(int bandCount = 0);
+	
+	void render(cairo::Context &target, int width, int height, DrawFn drawBand);
+	void renderBand(size_t band, DrawFn drawBand);
+	
+	// started once with the renderer, so a frame only wakes its threads
+	WorkerPool mPool;
+	int mBandCount;
+	int mWidth, mHeight;
+	vector<Area> mBands;
+	vector<cairo::SurfaceImage> mSurfaces;
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include "cinder/cairo/Cairo.h"
+#include "DrawSink.h"
+#include <cstdio>
+#include <vector>
+
+using namespace ci;
+using namespace std;
+
+// Records drawing calls as a compact list of opcodes and float arguments, so
+// a frame can be captured once and replayed later into any number of sinks,
+// for example one PDF and one SVG surface. Whenever the list passes its chunk
+// size the chunk is appended to a temporary file, so the list itself never
+// holds more than one chunk in memory however much is recorded, and replay()
+// reads the chunks back one at a time. The PDF and SVG surfaces it replays
+// into still keep their whole page until they are finished. Only the calls of
+// DrawSink are covered.
+class DisplayList : public DrawSink {
+public:
+	enum Op { SOURCE_COLOR, SOURCE_RADIAL, CIRCLE, RECTANGLE, MOVE_TO, LINE_TO, CLOSE_PATH, LINE_WIDTH, FILL, STROKE, PAINT };
+	
+	DisplayList(size_t chunkBytes = 64 * 1024);
+	~DisplayList();
+	
+	void setSource(const ColorAf &color);
+	// A radial gradient from (center0, radius0) in color0 to (center1, radius1) in color1
+	void setSourceRadial(const Vec2f &center0, float radius0, const Vec2f &center1, float radius1, const ColorAf &color0, const ColorAf &color1);
+	void circle(const Vec2f &center, float radius);
+	void rectangle(float x, float y, float width, float height);
+	void moveTo(const Vec2f &point);
+	void lineTo(const Vec2f &point);
+	void closePath();
+	void setLineWidth(float width);
+	void fill();
+	void stroke();
+	void paint();
+	
+	// Plays every recorded call into sink, in order. The list is unchanged.
+	// Returns false, having played only part of the list, if the temporary
+	// file could not be read back.
+	bool replay(DrawSink &sink) const;
+	// Forgets everything recorded and the temporary file with it
+	void clear();
+	bool empty() const;
+	// Calls recorded since construction or clear()
+	size_t getCallCount() const;
+	// Bytes written to the temporary file
+	size_t getSpilledSize() const;
+	
+	void add(Op op);
+	void add(float value);
+	void add(const ColorAf &color);
+	// Appends the chunk in memory to the temporary file and empties it
+	void spill();
+	static void play(DrawSink &sink, const vector<uint8_t> &ops, const vector<float> &args);
+	
+	size_t mChunkBytes;
+	vector<uint8_t> mOps;
+	vector<float> mArgs;
+	// the spilled chunks, each an op count, an argument count, the ops and the arguments
+	FILE *mFile;
+	size_t mSpilled;
+	size_t mCalls;
+	// set once the temporary file cannot be created or written
+	bool mStayInMemory;
+	
+private:
+	// the temporary file is not shared
+	DisplayList(const DisplayList &);
+	DisplayList &operator=(const DisplayList &);
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "cinder/cairo/Cairo.h"
+
+using namespace ci;
+using namespace std;
+
+// The drawing calls shared by on-screen drawing and export. Code that draws
+// through a DrawSink draws the same shapes whether they go straight into a
+// cairo context (ContextSink) or are recorded to be replayed later (DisplayList).
+class DrawSink {
+public:
+	virtual ~DrawSink() {}
+	
+	virtual void setSource(const ColorAf &color) = 0;
+	// A radial gradient from (center0, radius0) in color0 to (center1, radius1) in color1
+	virtual void setSourceRadial(const Vec2f &center0, float radius0, const Vec2f &center1, float radius1, const ColorAf &color0, const ColorAf &color1) = 0;
+	virtual void circle(const Vec2f &center, float radius) = 0;
+	virtual void rectangle(float x, float y, float width, float height) = 0;
+	virtual void moveTo(const Vec2f &point) = 0;
+	virtual void lineTo(const Vec2f &point) = 0;
+	virtual void closePath() = 0;
+	virtual void setLineWidth(float width) = 0;
+	virtual void fill() = 0;
+	virtual void stroke() = 0;
+	virtual void paint() = 0;
+};
+
+// Passes every call straight on to a cairo context
+class ContextSink : public DrawSink {
+public:
+	ContextSink(cairo::Context &ctx);
+	
+	void setSource(const ColorAf &color);
+	void setSourceRadial(const Vec2f &center0, float radius0, const Vec2f &center1, float radius1, const ColorAf &color0, const ColorAf &color1);
+	void circle(const Vec2f &center, float radius);
+	void rectangle(float x, float y, float width, float height);
+	void moveTo(const Vec2f &point);
+	void lineTo(const Vec2f &point);
+	void closePath();
+	void setLineWidth(float width);
+	void fill();
+	void stroke();
+	void paint();
+	
+	cairo::Context &mCtx;
+};
@@ -1,18 +1,56 @@
 #pragma once
 #include "cinder/cairo/Cairo.h"
+#include <memory>
 
 using namespace ci;
 using namespace std;
 
+// The layout DropletField replaced: one heap node per droplet in a
+// list<Droplet>, each droplet holding its own copy of the context. Only kept
+// so benchmarkLayouts() can measure the two side by side.
 class Droplet {
 public:
-    Droplet();
+	Droplet();
 	Droplet(Vec2i pixel, cairo::Context &ctx, Colorf average, int cellSize);
 	
-    void draw();
+	void draw();
+	
+	cairo::Context mCtx;
+	Vec2f mPosition;
+	float mRadius;
+	Colorf mColor;
+};
+
+// What every CountingAllocator has taken from the heap and not given back
+struct AllocationCount {
+	static void reset();
+	
+	static size_t sBytes;
+	static size_t sAllocations;
+};
 
-    cairo::Context mCtx;
-    Vec2f mPosition;
-    float mRadius;
-	Colorf mColor;	
-};
\ No newline at end of file
+// std::allocator that adds each request to AllocationCount, so the memory of
+// a container is read off rather than estimated. Allocator overhead per block
+// is not included.
+template<typename T>
+class CountingAllocator : public std::allocator<T> {
+public:
+	template<typename U> struct rebind { typedef CountingAllocator<U> other; };
+	
+	CountingAllocator() {}
+	CountingAllocator(const CountingAllocator &other) : std::allocator<T>(other) {}
+	template<typename U> CountingAllocator(const CountingAllocator<U> &other) {}
+	
+	T* allocate(size_t count, const void *hint = 0)
+	{
+		AllocationCount::sBytes += count * sizeof(T);
+		AllocationCount::sAllocations++;
+		return std::allocator<T>::allocate(count, hint);
+	}
+	void deallocate(T *pointer, size_t count)
+	{
+		AllocationCount::sBytes -= count * sizeof(T);
+		AllocationCount::sAllocations--;
+		std::allocator<T>::deallocate(pointer, count);
+	}
+};
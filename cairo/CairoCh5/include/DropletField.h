@@ -0,0 +1,37 @@
+#pragma once
+#include "cinder/cairo/Cairo.h"
+#include "cinder/Area.h"
+#include "DropletSprites.h"
+#include "DrawSink.h"
+#include <vector>
+
+using namespace ci;
+using namespace std;
+
+// All of the droplets, stored as a structure of arrays: droplet i is
+// mPositions[i], mRadii[i] and mColors[i]. Each array is one contiguous block,
+// so building and culling the field walks memory in order, and the context
+// to draw into is passed to draw() instead of being copied into every droplet.
+class DropletField {
+public:
+	DropletField();
+	
+	void clear();
+	void reserve(size_t count);
+	void add(Vec2f position, float radius, Colorf color);
+	size_t size() const;
+	
+	// Draws every droplet whose shadow reaches into area, stamping the cached
+	// sprite for its radius or falling back to drawDroplet()
+	void draw(cairo::Context &ctx, Area area, DropletSprites &sprites) const;
+	// Draws every droplet with drawDroplet(), for resolution independent export
+	void record(DrawSink &sink) const;
+	// Droplet i as vector shapes: a gradient shadow and a disc
+	void drawDroplet(DrawSink &sink, size_t i) const;
+	// Bytes held by the three arrays
+	size_t getMemorySize() const;
+	
+	vector<Vec2f> mPositions;
+	vector<float> mRadii;
+	vector<Colorf> mColors;
+};
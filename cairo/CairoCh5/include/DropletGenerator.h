@@ -0,0 +1,62 @@
+#pragma once
+#include "cinder/Area.h"
+#include "DropletField.h"
+#include "SummedAreaTable.h"
+#include "TiledImage.h"
+#include "WorkerPool.h"
+#include <boost/thread.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+using namespace ci;
+using namespace std;
+
+// Builds a DropletField off the main thread. Jobs run on a thread that stays
+// up for the life of the generator, and the droplets are split into fixed
+// chunks of CHUNK_SIZE spread across its own WorkerPool, so starting a job
+// spawns nothing. Positions come from
+// Philox streams indexed by droplet number under the job seed, so the field
+// comes out identical no matter how many threads share the chunks. The
+// finished field only reaches the app through publish(), which swaps it in whole.
+class DropletGenerator : private boost::noncopyable {
+public:
+	static const int CHUNK_SIZE = 4096;
+	
+	DropletGenerator();
+	~DropletGenerator();
+	
+	// Cancels any running job and starts building count droplets for a
+	// width x height window, colored from tiles when given and table otherwise.
+	// table is only read, and has to outlive the job.
+	void start(const SummedAreaTable &table, boost::shared_ptr<TiledImage> tiles, int width, int height, int cellSize, int count, uint32_t seed);
+	// Blocks until the running job, if any, is done
+	void wait();
+	// Swaps a finished field into field and returns true, or returns false
+	// while the job is still running or nothing new is waiting
+	bool publish(DropletField &field);
+	
+	// Mean color of the cellSize cell centered on pixel
+	Colorf getColor(Vec2i pixel) const;
+	
+	// The job thread: sleeps until start() hands it a job, then runs it
+	void loop();
+	void run();
+	void generateChunk(size_t chunk);
+	
+	const SummedAreaTable *mTable;
+	boost::shared_ptr<TiledImage> mTiles;
+	int mWidth, mHeight, mCellSize, mCount;
+	uint32_t mSeed;
+	
+	DropletField mPending;
+	bool mReady;
+	volatile bool mCancel;
+	// a job has been started and is not finished yet
+	bool mBusy;
+	bool mQuit;
+	boost::mutex mMutex;
+	// signalled when a job starts or finishes, and on quit
+	boost::condition_variable mChanged;
+	boost::thread mThread;
+	WorkerPool mPool;
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include "cinder/cairo/Cairo.h"
+#include <map>
+
+using namespace ci;
+using namespace std;
+
+// The shadow and disc of a droplet of one radius, rendered once into alpha
+// masks. Both masks share an origin; the droplet center sits at (mExtent, mExtent).
+class DropletSprite {
+public:
+	DropletSprite();
+	DropletSprite(float radius);
+	
+	// Tints the shadow and then the disc with color, centered on position
+	// rounded to the nearest pixel
+	void stamp(cairo::Context &ctx, const Vec2f &position, const Colorf &color);
+	
+	int mExtent;
+	cairo::SurfaceImage mShadow;
+	cairo::SurfaceImage mDisc;
+};
+
+// One DropletSprite per distinct droplet radius. Radii follow cellSize, so
+// the cache is cleared whenever cellSize changes. Sprites are only added
+// from the main thread, before the band threads start reading them.
+class DropletSprites {
+public:
+	DropletSprites();
+	
+	void clear();
+	// Renders the sprite for radius unless it is cached already
+	void prepare(float radius);
+	// The cached sprite for radius, or NULL
+	DropletSprite* get(float radius);
+	
+	map<float, DropletSprite> mSprites;
+};
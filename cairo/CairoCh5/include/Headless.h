@@ -0,0 +1,83 @@
+#pragma once
+#include "cinder/cairo/Cairo.h"
+#include "cinder/ImageIo.h"
+// a headless build has no window and links no app framework, so only the event types come along
+#if defined( HEADLESS )
+#include "cinder/app/KeyEvent.h"
+#include "cinder/app/MouseEvent.h"
+#else
+#include "cinder/app/AppBasic.h"
+#endif
+#include "FrameStats.h"
+#include <string>
+#include <iostream>
+
+using namespace ci;
+using namespace ci::app;
+using namespace std;
+
+// Apps derive from AppBase and end with CINDER_APP instead of CINDER_APP_BASIC.
+// Normally that is just AppBasic. Built with HEADLESS defined, as the Headless
+// configuration of the xcode project does, the app gets no window: main()
+// runs setup, then update and draw for a fixed number of frames on an image
+// surface, optionally writing each frame out as a png. Run it as
+//   app [--frames 300] [--size 640x480] [--dump directory] [--resources ../resources/]
+//       [--warmup 0] [--bench results.json] [--name scenario] [app options]
+// Time advances a fixed 1/60s per frame so runs are repeatable. With --bench,
+// update and draw are timed for every frame after the warmup frames and their
+// percentiles appended to the file, see FrameStats.
+#if defined( HEADLESS )
+
+class HeadlessApp {
+public:
+	HeadlessApp();
+	virtual ~HeadlessApp() {}
+	
+	virtual void setup() {}
+	virtual void update() {}
+	virtual void draw() {}
+	virtual void shutdown() {}
+	// Options the runner does not know are passed here in command-line order,
+	// before setup; return false to reject one
+	virtual bool setOption(const string &name, const string &value) { return false; }
+	
+	// Stands in for cairo::createWindowSurface(), handing out the offscreen frame
+	cairo::SurfaceBase createWindowSurface() { return mSurface; }
+	
+	int getWindowWidth() const { return mWidth; }
+	int getWindowHeight() const { return mHeight; }
+	Vec2i getWindowSize() const { return Vec2i(mWidth, mHeight); }
+	Area getWindowBounds() const { return Area(0, 0, mWidth, mHeight); }
+	uint32_t getElapsedFrames() const { return mFrame; }
+	double getElapsedSeconds() const { return mFrame / 60.0; }
+	ostream& console() { return cout; }
+	DataSourceRef loadResource(const string &name) { return loadFile(mResources + name); }
+	// there is no one to answer a dialog
+	string getFolderPath() { return ""; }
+	string getSaveFilePath() { return ""; }
+	
+	// Parses the command line, then drives app and deletes it
+	static int run(HeadlessApp *app, int argc, char *argv[]);
+	void dumpFrame();
+	
+	int mWidth, mHeight;
+	uint32_t mFrame, mFrames, mWarmup;
+	string mBenchPath, mName;
+	FrameStats mStats;
+	string mDumpDirectory, mResources;
+	cairo::SurfaceImage mSurface;
+};
+
+typedef HeadlessApp AppBase;
+#define CINDER_APP( APP, RENDERER ) int main(int argc, char *argv[]) { return HeadlessApp::run(new APP, argc, argv); }
+
+#else
+
+class AppBase : public AppBasic {
+public:
+	cairo::SurfaceBase createWindowSurface() { return cairo::createWindowSurface(); }
+};
+
+#define CINDER_APP( APP, RENDERER ) CINDER_APP_BASIC( APP, RENDERER )
+
+#endif
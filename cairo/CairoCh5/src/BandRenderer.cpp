@@ -0,0 +1,49 @@
+#include "BandRenderer.h"
+#include "Trace.h"
+#include <boost/bind.hpp>
+
+BandRenderer::BandRenderer(int bandCount)
+	: mPool(bandCount)
+{
+	mBandCount = mPool.getThreadCount();
+	mWidth = 0;
+	mHeight = 0;
+}
+
+void BandRenderer::render(cairo::Context &target, int width, int height, DrawFn drawBand)
+{
+	// the band surfaces only change with the window size
+	if( width != mWidth || height != mHeight ){
+		mWidth = width;
+		mHeight = height;
+		mBands.clear();
+		mSurfaces.clear();
+		
+		int bandHeight = ( height + mBandCount - 1 ) / mBandCount;
+		for( int y = 0; y < height; y += bandHeight ){
+			Area band = Area( 0, y, width, min( y + bandHeight, height ) );
+			mBands.push_back( band );
+			mSurfaces.push_back( cairo::SurfaceImage( band.getWidth(), band.getHeight(), false ) );
+		}
+	}
+	
+	// the calling thread is one of the pool's and takes a band itself
+	mPool.run( mBands.size(), boost::bind( &BandRenderer::renderBand, this, _1, drawBand ) );
+	
+	for( size_t i = 0; i < mBands.size(); i++ ){
+		target.setSourceSurface( mSurfaces[i], mBands[i].x1, mBands[i].y1 );
+		target.rectangle( mBands[i].x1, mBands[i].y1, mBands[i].getWidth(), mBands[i].getHeight() );
+		target.fill();
+	}
+}
+
+void BandRenderer::renderBand(size_t band, DrawFn drawBand)
+{
+	TRACE_ZONE("band");
+	Area area = mBands[band];
+	cairo::Context ctx( mSurfaces[band] );
+	ctx.translate( -area.x1, -area.y1 );
+	ctx.rectangle( area.x1, area.y1, area.getWidth(), area.getHeight() );
+	ctx.clip();
+	drawBand( ctx, area );
+}
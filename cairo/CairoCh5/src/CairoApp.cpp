@@ -1,30 +1,64 @@
-#include "cinder/app/AppBasic.h"
+#include "Headless.h"
 #include "cinder/cairo/Cairo.h"
 #include "cinder/ImageIo.h"
+#include "DropletField.h"
+#include "DisplayList.h"
 #include "Droplet.h"
+#include "DropletGenerator.h"
+#include "SummedAreaTable.h"
+#include "BandRenderer.h"
+#include "Trace.h"
 #include "cinder/Rand.h"
-#include <list> 
+#include "cinder/Timer.h"
+#include <vector>
+#include <list>
+#include <cstdlib>
+#include <boost/bind.hpp>
 
 using namespace ci;
 using namespace ci::app;
 using namespace std;
 
 
-class cairoApp : public AppBasic {
+class cairoApp : public AppBase {
 public:
+	cairoApp();
 	void setup();
 	void update();
 	void draw();
-	void makeDroplet(); 
+	void drawDroplets(cairo::Context &target, Area area);
+	void makeDroplets();
 	void keyDown(KeyEvent event);
+	bool setOption(const string &name, const string &value);
 	int countCalculator();
-	Colorf getColor(Surface32f surface, Vec2i pixel);
+	void benchmarkMeans();
+	void benchmarkLayouts();
+	void recordFrame();
+	void exportFrame(const string &path);
 	
 	cairo::Context ctx;
-	Surface32f surface;
+	PlanarImage image;
+	SummedAreaTable table;
 	
 	int cellSize;
-	list<Droplet> droplets;
+	DropletField droplets;
+	DropletSprites sprites;
+	DropletGenerator generator;
+	uint32_t seed;
+	
+	// an out-of-core tile set replacing sunset.png once opened with 't'
+	boost::shared_ptr<TiledImage> tiles;
+	
+	BandRenderer bands;
+	bool useBands;
+	
+	// the frame captured by recordFrame(), for exportFrame() to replay
+	DisplayList recording;
+	
+	// headless runs: what to export and which benchmarks to print once setup() is done
+	string exportPath;
+	bool meanBenchmark;
+	bool layoutBenchmark;
 };
 
 int cairoApp::countCalculator()
@@ -37,6 +71,39 @@ int cairoApp::countCalculator()
 
 void cairoApp::keyDown(KeyEvent event)
 {
+	if( event.getCode() == KeyEvent::KEY_F1 ) {
+		Trace::write();
+		return;
+	}
+	// 'r' captures the current field as vectors; 'e' exports the capture, taking
+	// one first if there is none, to pdf when the name ends in .pdf and svg otherwise
+	if( event.getChar() == 'r' ) {
+		recordFrame();
+		return;
+	}
+	if( event.getChar() == 'e' ) {
+		string path = getSaveFilePath();
+		if( ! path.empty() ) {
+			if( recording.empty() ) {
+				recordFrame();
+			}
+			exportFrame(path);
+		}
+		return;
+	}
+	// 'p' switches between banded rendering on all cores and the main thread only
+	if( event.getChar() == 'p' ) {
+		useBands = ! useBands;
+		return;
+	}
+	if( event.getChar() == 't' ) {
+		string directory = getFolderPath();
+		if( ! directory.empty() ) {
+			tiles = boost::shared_ptr<TiledImage>( new TiledImage(directory, 256 * 1024 * 1024) );
+			tiles->prefetch( getWindowBounds() );
+		}
+	}
+	
 	if( event.getChar() == '1' ) {
 		cellSize -= 2;
 	} else if (event.getChar()== '2') {
@@ -50,90 +117,290 @@ void cairoApp::keyDown(KeyEvent event)
 		cellSize = getWindowWidth();
 	}
 	
-	droplets.clear();
-	
-	for(int i = 0; i < countCalculator(); i++){
-		makeDroplet();  
+	// the old field keeps drawing until update() publishes the new one
+	sprites.prepare(cellSize * 0.5f);
+	makeDroplets();
+}
+
+// headless benchmark options, see Headless.h
+bool cairoApp::setOption(const string &name, const string &value)
+{
+	if( name == "--cell-size" ) {
+		cellSize = max(atoi(value.c_str()), 2);
+	} else if( name == "--bands" ) {
+		useBands = atoi(value.c_str()) != 0;
+	} else if( name == "--export" ) {
+		exportPath = value;
+	} else if( name == "--mean-benchmark" ) {
+		meanBenchmark = atoi(value.c_str()) != 0;
+	} else if( name == "--layout-benchmark" ) {
+		layoutBenchmark = atoi(value.c_str()) != 0;
+	} else {
+		return false;
 	}
+	return true;
 }
 
-void cairoApp::makeDroplet()
+// Starts building a new field for the current cellSize in the background.
+// Every field gets a fresh seed; the thread count never changes the result.
+void cairoApp::makeDroplets()
 {
-	int x = Rand::randInt(getWindowWidth());
-	int y = Rand::randInt(getWindowHeight());
-	Vec2i pixel = Vec2i(x, y);
-	Colorf average = getColor(surface, pixel);
-	droplets.push_back(Droplet(pixel, ctx, average, cellSize));
+	seed++;
+	generator.start(table, tiles, getWindowWidth(), getWindowHeight(), cellSize, countCalculator(), seed);
 }
 
-Colorf cairoApp::getColor( Surface32f surface, Vec2i pixel){
-	
-	Vec2i UL = Vec2i(pixel.x - cellSize * 0.5f, pixel.y - cellSize * 0.5f);
-	Vec2i LR = Vec2i(pixel.x + cellSize * 0.5f, pixel.y + cellSize * 0.5f);
-	
-	if(UL.x < 0){
-		UL.x = 0;
-	}
-	if(UL.y < 0){
-		UL.y = 0;
-	}
-	if(LR.x > getWindowWidth() ){
-		LR.x = getWindowWidth();
-	}
-	if(LR.y > getWindowHeight() ){
-		LR.y = getWindowHeight();
-	}
-	
-	int totalPixels = 0;
+// The per-pixel Surface32f loop getColor used before the table, kept for benchmarkMeans()
+static Colorf surfaceAverage( Surface32f &surface, Area area )
+{
 	float rTotal = 0.0f;
 	float gTotal = 0.0f;
 	float bTotal = 0.0f;
 	
-	for(int x = int(UL.x); x <= int(LR.x); x++){
-		
-		for(int y = int(UL.y); y <= int(LR.y); y++){
-			
+	for(int x = area.x1; x < area.x2; x++){
+		for(int y = area.y1; y < area.y2; y++){
 			Vec2i currentPixel = Vec2i(x,y);
-			float r = *surface.getDataRed(currentPixel);
-			float g = *surface.getDataGreen(currentPixel);
-			float b = *surface.getDataBlue(currentPixel);
-			
-			rTotal += r;
-			gTotal += g;
-			bTotal += b;
-			totalPixels++;
+			rTotal += *surface.getDataRed(currentPixel);
+			gTotal += *surface.getDataGreen(currentPixel);
+			bTotal += *surface.getDataBlue(currentPixel);
 		}
 	}
 	
-	float r = rTotal / totalPixels;
-	float g = gTotal / totalPixels;
-	float b = bTotal / totalPixels;
+	int totalPixels = area.getWidth() * area.getHeight();
+	return Colorf( rTotal / totalPixels, gTotal / totalPixels, bTotal / totalPixels );
+}
+
+// Times the old Surface32f loop, PlanarImage::getMean and the summed-area
+// table on the same cells and prints the results to stdout, along with the
+// memory each needs and the largest difference 8-bit storage introduces.
+// Only run from the headless runner, see benchmark.sh.
+void cairoApp::benchmarkMeans()
+{
+	Surface32f reference = Surface32f( loadImage( loadResource("sunset.png") ) );
+	
+	Rand rand(1);
+	vector<Area> cells;
+	for(int i = 0; i < 10000; i++){
+		int x = rand.nextInt(image.mWidth);
+		int y = rand.nextInt(image.mHeight);
+		Area cell = Area(x - cellSize / 2, y - cellSize / 2, x + cellSize / 2 + 1, y + cellSize / 2 + 1);
+		cell.clipBy( Area(0, 0, image.mWidth, image.mHeight) );
+		cells.push_back(cell);
+	}
+	
+	vector<Colorf> surfaceColors;
+	Timer timer;
+	timer.start();
+	for(size_t i = 0; i < cells.size(); i++){
+		surfaceColors.push_back( surfaceAverage(reference, cells[i]) );
+	}
+	timer.stop();
+	double surfaceSeconds = timer.getSeconds();
+	
+	vector<Colorf> planarColors;
+	timer.start();
+	for(size_t i = 0; i < cells.size(); i++){
+		planarColors.push_back( image.getMean(cells[i]) );
+	}
+	timer.stop();
+	double planarSeconds = timer.getSeconds();
+	
+	vector<Colorf> tableColors;
+	timer.start();
+	for(size_t i = 0; i < cells.size(); i++){
+		tableColors.push_back( table.getAverage(cells[i]) );
+	}
+	timer.stop();
+	double tableSeconds = timer.getSeconds();
+	
+	float maxDifference = 0.0f;
+	float tableDifference = 0.0f;
+	for(size_t i = 0; i < cells.size(); i++){
+		maxDifference = max( maxDifference, abs(surfaceColors[i].r - planarColors[i].r) );
+		maxDifference = max( maxDifference, abs(surfaceColors[i].g - planarColors[i].g) );
+		maxDifference = max( maxDifference, abs(surfaceColors[i].b - planarColors[i].b) );
+		tableDifference = max( tableDifference, abs(tableColors[i].r - planarColors[i].r) + abs(tableColors[i].g - planarColors[i].g)
+			+ abs(tableColors[i].b - planarColors[i].b) );
+	}
 	
-	return Colorf( r, g, b );
+	console() << "getColor benchmark: " << cells.size() << " cells at cellSize " << cellSize << endl;
+	console() << "  Surface32f loop:   " << surfaceSeconds * 1000.0 << " ms, " << reference.getRowBytes() * reference.getHeight() << " bytes" << endl;
+	console() << "  PlanarImage SIMD:  " << planarSeconds * 1000.0 << " ms, " << image.getMemorySize() << " bytes" << endl;
+	console() << "  SummedAreaTable:   " << tableSeconds * 1000.0 << " ms, " << image.getMemorySize() + table.getMemorySize() << " bytes, "
+		<< tableDifference << " from PlanarImage" << endl;
+	console() << "  max 8-bit difference: " << maxDifference << endl;
 }
 
-void cairoApp::setup()
+// defaults for what setOption() can change, which runs before setup()
+cairoApp::cairoApp()
 {
-	ctx = cairo::Context(cairo::createWindowSurface());
-	surface = Surface32f( loadImage( loadResource("sunset.png") ) );
 	cellSize = 10;
+	useBands = true;
+	meanBenchmark = false;
+	layoutBenchmark = false;
+}
+
+void cairoApp::setup()
+{
+	ctx = cairo::Context(createWindowSurface());
+	image = PlanarImage( Surface32f( loadImage( loadResource("sunset.png") ) ) );
+	table.setSource(image);
+	sprites.prepare(cellSize * 0.5f);
+	seed = 0;
 	
-	for(int i = 0; i < countCalculator(); i++){
-		makeDroplet();  
+	makeDroplets();
+	generator.wait();
+	generator.publish(droplets);
+	
+	if( meanBenchmark ) {
+		benchmarkMeans();
+	}
+	if( layoutBenchmark ) {
+		benchmarkLayouts();
+	}
+	// one recording, replayed into every comma separated path
+	if( ! exportPath.empty() ) {
+		recordFrame();
+		size_t begin = 0;
+		while( begin <= exportPath.size() ) {
+			size_t end = min(exportPath.find(',', begin), exportPath.size());
+			if( end > begin ) {
+				exportFrame(exportPath.substr(begin, end - begin));
+			}
+			begin = end + 1;
+		}
 	}
 }
 
 void cairoApp::update()
 {
+	TRACE_ZONE("update");
+	// swap in a finished field and drop the sprites only the old one used
+	if (generator.publish(droplets)) {
+		sprites.clear();
+		if (droplets.size() > 0) {
+			sprites.prepare(droplets.mRadii[0]);
+		}
+	}
 }
 
 void cairoApp::draw()
 {
-	ctx.setSource(Colorf(0.5,0.5,0.5));
-	ctx.paint();
-	for( list<Droplet>::iterator i = droplets.begin(); i != droplets.end(); ++i ) {
-        i->draw();
-    }
+	TRACE_ZONE("draw");
+	if (useBands) {
+		bands.render(ctx, getWindowWidth(), getWindowHeight(), boost::bind(&cairoApp::drawDroplets, this, _1, _2));
+	} else {
+		drawDroplets(ctx, getWindowBounds());
+	}
+}
+
+// Draws the background and every droplet whose shadow reaches into area.
+// Called from several band threads at once, so it only reads the droplets.
+void cairoApp::drawDroplets(cairo::Context &target, Area area)
+{
+	target.setSource(Colorf(0.5,0.5,0.5));
+	target.paint();
+	droplets.draw(target, area, sprites);
+}
+
+// Records the background and every droplet into the display list, replacing
+// what it held. Chunks past the first go to a temporary file, not memory.
+void cairoApp::recordFrame()
+{
+	Timer timer;
+	timer.start();
+	recording.clear();
+	recording.setSource(ColorAf(0.5, 0.5, 0.5, 1));
+	recording.paint();
+	droplets.record(recording);
+	timer.stop();
+	console() << "recorded " << droplets.size() << " droplets (" << recording.getCallCount() << " calls, " << recording.getSpilledSize() << " bytes spilled) in " << timer.getSeconds() << " s" << endl;
+}
+
+// Replays the recording into a vector surface. The surface itself holds the
+// whole page until it is written.
+void cairoApp::exportFrame(const string &path)
+{
+	Timer timer;
+	timer.start();
+	bool complete;
+	{
+		bool pdf = path.size() >= 4 && path.substr(path.size() - 4) == ".pdf";
+		cairo::SurfaceBase surface = pdf ? (cairo::SurfaceBase)cairo::SurfacePdf(path, getWindowWidth(), getWindowHeight())
+			: (cairo::SurfaceBase)cairo::SurfaceSvg(path, getWindowWidth(), getWindowHeight());
+		cairo::Context target(surface);
+		ContextSink sink(target);
+		complete = recording.replay(sink);
+	}
+	// the surface is finished and written once the context and surface are gone
+	timer.stop();
+	if( ! complete ) {
+		console() << "export to " << path << " is incomplete: the recording could not be read back" << endl;
+	}
+	console() << "exported " << recording.getCallCount() << " calls to " << path << " in " << timer.getSeconds() << " s" << endl;
+}
+
+// Copies the current field into the old list<Droplet> layout and prints the
+// heap both take and the time both need to draw it with gradients on the main
+// thread, into the same image surface. The list's memory comes from
+// CountingAllocator, the field's from the capacity of its arrays. Only run
+// from the headless runner, see benchmark.sh.
+void cairoApp::benchmarkLayouts()
+{
+	const int frames = 10;
+	cairo::SurfaceImage surface(getWindowWidth(), getWindowHeight(), false);
+	cairo::Context target(surface);
+	
+	AllocationCount::reset();
+	list<Droplet, CountingAllocator<Droplet> > dropletList;
+	Timer timer;
+	timer.start();
+	for(size_t i = 0; i < droplets.size(); i++){
+		dropletList.push_back( Droplet(Vec2i(droplets.mPositions[i].x, droplets.mPositions[i].y), target, droplets.mColors[i], cellSize) );
+	}
+	timer.stop();
+	double listBuildSeconds = timer.getSeconds();
+	size_t listBytes = AllocationCount::sBytes;
+	size_t listAllocations = AllocationCount::sAllocations;
+	
+	timer.start();
+	for(int frame = 0; frame < frames; frame++){
+		target.setSource(Colorf(0.5,0.5,0.5));
+		target.paint();
+		for(list<Droplet, CountingAllocator<Droplet> >::iterator it = dropletList.begin(); it != dropletList.end(); ++it){
+			it->draw();
+		}
+		surface.flush();
+	}
+	timer.stop();
+	double listSeconds = timer.getSeconds() / frames;
+	
+	// copying the field is what the generator does when it publishes one
+	timer.start();
+	DropletField field;
+	field.reserve(droplets.size());
+	for(size_t i = 0; i < droplets.size(); i++){
+		field.add(droplets.mPositions[i], droplets.mRadii[i], droplets.mColors[i]);
+	}
+	timer.stop();
+	double fieldBuildSeconds = timer.getSeconds();
+	
+	// no sprites prepared, so every droplet takes the same gradient path as Droplet::draw
+	DropletSprites noSprites;
+	timer.start();
+	for(int frame = 0; frame < frames; frame++){
+		target.setSource(Colorf(0.5,0.5,0.5));
+		target.paint();
+		field.draw(target, getWindowBounds(), noSprites);
+		surface.flush();
+	}
+	timer.stop();
+	double fieldSeconds = timer.getSeconds() / frames;
+	
+	console() << "layout benchmark: " << droplets.size() << " droplets at cellSize " << cellSize << ", " << frames << " frames" << endl;
+	console() << "  list<Droplet>:  " << listBytes << " bytes in " << listAllocations << " allocations, built in "
+		<< listBuildSeconds * 1000.0 << " ms, " << listSeconds * 1000.0 << " ms per frame" << endl;
+	console() << "  DropletField:   " << field.getMemorySize() << " bytes in 3 allocations, built in "
+		<< fieldBuildSeconds * 1000.0 << " ms, " << fieldSeconds * 1000.0 << " ms per frame" << endl;
 }
 
-CINDER_APP_BASIC( cairoApp, Renderer2d )
\ No newline at end of file
+CINDER_APP( cairoApp, Renderer2d )
\ No newline at end of file
@@ -0,0 +1,246 @@
+#include "DisplayList.h"
+
+DisplayList::DisplayList(size_t chunkBytes)
+	: mChunkBytes(chunkBytes), mFile(NULL), mSpilled(0), mCalls(0), mStayInMemory(false)
+{
+	mOps.reserve( chunkBytes / 16 );
+	mArgs.reserve( chunkBytes / sizeof(float) );
+}
+
+DisplayList::~DisplayList()
+{
+	if( mFile ){
+		fclose( mFile );
+	}
+}
+
+void DisplayList::add(Op op)
+{
+	// a chunk only ends between calls, never inside one's arguments
+	if( mOps.size() + mArgs.size() * sizeof(float) >= mChunkBytes ){
+		spill();
+	}
+	mOps.push_back( op );
+	mCalls++;
+}
+
+void DisplayList::add(float value)
+{
+	mArgs.push_back( value );
+}
+
+void DisplayList::add(const ColorAf &color)
+{
+	mArgs.push_back( color.r );
+	mArgs.push_back( color.g );
+	mArgs.push_back( color.b );
+	mArgs.push_back( color.a );
+}
+
+void DisplayList::setSource(const ColorAf &color)
+{
+	add( SOURCE_COLOR );
+	add( color );
+}
+
+void DisplayList::setSourceRadial(const Vec2f &center0, float radius0, const Vec2f &center1, float radius1, const ColorAf &color0, const ColorAf &color1)
+{
+	add( SOURCE_RADIAL );
+	add( center0.x );
+	add( center0.y );
+	add( radius0 );
+	add( center1.x );
+	add( center1.y );
+	add( radius1 );
+	add( color0 );
+	add( color1 );
+}
+
+void DisplayList::circle(const Vec2f &center, float radius)
+{
+	add( CIRCLE );
+	add( center.x );
+	add( center.y );
+	add( radius );
+}
+
+void DisplayList::rectangle(float x, float y, float width, float height)
+{
+	add( RECTANGLE );
+	add( x );
+	add( y );
+	add( width );
+	add( height );
+}
+
+void DisplayList::moveTo(const Vec2f &point)
+{
+	add( MOVE_TO );
+	add( point.x );
+	add( point.y );
+}
+
+void DisplayList::lineTo(const Vec2f &point)
+{
+	add( LINE_TO );
+	add( point.x );
+	add( point.y );
+}
+
+void DisplayList::closePath()
+{
+	add( CLOSE_PATH );
+}
+
+void DisplayList::setLineWidth(float width)
+{
+	add( LINE_WIDTH );
+	add( width );
+}
+
+void DisplayList::fill()
+{
+	add( FILL );
+}
+
+void DisplayList::stroke()
+{
+	add( STROKE );
+}
+
+void DisplayList::paint()
+{
+	add( PAINT );
+}
+
+void DisplayList::spill()
+{
+	if( mOps.empty() || mStayInMemory ){
+		return;
+	}
+	if( ! mFile ){
+		mFile = tmpfile();
+	}
+	uint32_t counts[2] = { (uint32_t)mOps.size(), (uint32_t)mArgs.size() };
+	bool ok = mFile && fwrite( counts, sizeof(counts), 1, mFile ) == 1
+		&& fwrite( &mOps[0], mOps.size(), 1, mFile ) == 1
+		&& ( mArgs.empty() || fwrite( &mArgs[0], mArgs.size() * sizeof(float), 1, mFile ) == 1 );
+	if( ! ok ){
+		// without a file (or with a full disk) the rest of the list stays in
+		// memory; replay() only reads back the chunks written before this one
+		mStayInMemory = true;
+		return;
+	}
+	mSpilled += sizeof(counts) + mOps.size() + mArgs.size() * sizeof(float);
+	mOps.clear();
+	mArgs.clear();
+}
+
+bool DisplayList::replay(DrawSink &sink) const
+{
+	bool ok = true;
+	if( mSpilled > 0 ){
+		vector<uint8_t> ops;
+		vector<float> args;
+		fflush( mFile );
+		rewind( mFile );
+		size_t read = 0;
+		while( ok && read < mSpilled ){
+			uint32_t counts[2];
+			ok = fread( counts, sizeof(counts), 1, mFile ) == 1;
+			if( ok ){
+				ops.resize( counts[0] );
+				args.resize( counts[1] );
+				ok = fread( &ops[0], ops.size(), 1, mFile ) == 1
+					&& ( args.empty() || fread( &args[0], args.size() * sizeof(float), 1, mFile ) == 1 );
+			}
+			if( ok ){
+				play( sink, ops, args );
+				read += sizeof(counts) + ops.size() + args.size() * sizeof(float);
+			}
+		}
+		// later chunks are appended after the last good one
+		fseek( mFile, mSpilled, SEEK_SET );
+	}
+	if( ok ){
+		play( sink, mOps, mArgs );
+	}
+	return ok;
+}
+
+void DisplayList::clear()
+{
+	if( mFile ){
+		fclose( mFile );
+		mFile = NULL;
+	}
+	mSpilled = 0;
+	mCalls = 0;
+	mStayInMemory = false;
+	mOps.clear();
+	mArgs.clear();
+}
+
+bool DisplayList::empty() const
+{
+	return mCalls == 0;
+}
+
+size_t DisplayList::getCallCount() const
+{
+	return mCalls;
+}
+
+size_t DisplayList::getSpilledSize() const
+{
+	return mSpilled;
+}
+
+void DisplayList::play(DrawSink &sink, const vector<uint8_t> &ops, const vector<float> &args)
+{
+	const float *a = args.empty() ? NULL : &args[0];
+	for( size_t i = 0; i < ops.size(); i++ ){
+		switch( ops[i] ){
+			case SOURCE_COLOR:
+				sink.setSource( ColorAf( a[0], a[1], a[2], a[3] ) );
+				a += 4;
+				break;
+			case SOURCE_RADIAL:
+				sink.setSourceRadial( Vec2f( a[0], a[1] ), a[2], Vec2f( a[3], a[4] ), a[5], ColorAf( a[6], a[7], a[8], a[9] ), ColorAf( a[10], a[11], a[12], a[13] ) );
+				a += 14;
+				break;
+			case CIRCLE:
+				sink.circle( Vec2f( a[0], a[1] ), a[2] );
+				a += 3;
+				break;
+			case RECTANGLE:
+				sink.rectangle( a[0], a[1], a[2], a[3] );
+				a += 4;
+				break;
+			case MOVE_TO:
+				sink.moveTo( Vec2f( a[0], a[1] ) );
+				a += 2;
+				break;
+			case LINE_TO:
+				sink.lineTo( Vec2f( a[0], a[1] ) );
+				a += 2;
+				break;
+			case CLOSE_PATH:
+				sink.closePath();
+				break;
+			case LINE_WIDTH:
+				sink.setLineWidth( a[0] );
+				a += 1;
+				break;
+			case FILL:
+				sink.fill();
+				break;
+			case STROKE:
+				sink.stroke();
+				break;
+			case PAINT:
+				sink.paint();
+				break;
+		}
+	}
+}
@@ -0,0 +1,64 @@
+#include "DrawSink.h"
+
+ContextSink::ContextSink(cairo::Context &ctx)
+	: mCtx(ctx)
+{
+}
+
+void ContextSink::setSource(const ColorAf &color)
+{
+	mCtx.setSource( color );
+}
+
+void ContextSink::setSourceRadial(const Vec2f &center0, float radius0, const Vec2f &center1, float radius1, const ColorAf &color0, const ColorAf &color1)
+{
+	cairo::GradientRadial gradient( center0, radius0, center1, radius1 );
+	gradient.addColorStop( 0, color0 );
+	gradient.addColorStop( 1, color1 );
+	mCtx.setSource( gradient );
+}
+
+void ContextSink::circle(const Vec2f &center, float radius)
+{
+	mCtx.circle( center.x, center.y, radius );
+}
+
+void ContextSink::rectangle(float x, float y, float width, float height)
+{
+	mCtx.rectangle( x, y, width, height );
+}
+
+void ContextSink::moveTo(const Vec2f &point)
+{
+	mCtx.moveTo( point.x, point.y );
+}
+
+void ContextSink::lineTo(const Vec2f &point)
+{
+	mCtx.lineTo( point.x, point.y );
+}
+
+void ContextSink::closePath()
+{
+	mCtx.closePath();
+}
+
+void ContextSink::setLineWidth(float width)
+{
+	mCtx.setLineWidth( width );
+}
+
+void ContextSink::fill()
+{
+	mCtx.fill();
+}
+
+void ContextSink::stroke()
+{
+	mCtx.stroke();
+}
+
+void ContextSink::paint()
+{
+	mCtx.paint();
+}
@@ -1,12 +1,21 @@
 #include "Droplet.h"
 #include "cinder/cairo/Cairo.h"
 
+size_t AllocationCount::sBytes = 0;
+size_t AllocationCount::sAllocations = 0;
+
+void AllocationCount::reset()
+{
+	sBytes = 0;
+	sAllocations = 0;
+}
+
 Droplet::Droplet()
 {
 }
 
 Droplet::Droplet(Vec2i pixel, cairo::Context &ctx, Colorf average, int cellSize)
-{       
+{
 	mPosition = Vec2f(pixel.x, pixel.y);
 	mCtx = ctx;
 	mRadius = cellSize * 0.5f;
@@ -26,4 +35,4 @@ void Droplet::draw()
 	mCtx.circle(mPosition, mRadius);
 	mCtx.setSource(mColor);
 	mCtx.fill();
-}
\ No newline at end of file
+}
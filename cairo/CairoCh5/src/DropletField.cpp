@@ -0,0 +1,85 @@
+#include "DropletField.h"
+#include "Trace.h"
+
+DropletField::DropletField()
+{
+}
+
+void DropletField::clear()
+{
+	mPositions.clear();
+	mRadii.clear();
+	mColors.clear();
+}
+
+void DropletField::reserve(size_t count)
+{
+	mPositions.reserve(count);
+	mRadii.reserve(count);
+	mColors.reserve(count);
+}
+
+void DropletField::add(Vec2f position, float radius, Colorf color)
+{
+	mPositions.push_back(position);
+	mRadii.push_back(radius);
+	mColors.push_back(color);
+}
+
+size_t DropletField::size() const
+{
+	return mPositions.size();
+}
+
+void DropletField::draw(cairo::Context &ctx, Area area, DropletSprites &sprites) const
+{
+	TRACE_ZONE("DropletField::draw");
+	// radii come in runs, so only look the sprite up again when the radius changes
+	float spriteRadius = -1.0f;
+	DropletSprite *sprite = NULL;
+	ContextSink sink(ctx);
+	
+	for( size_t i = 0; i < mPositions.size(); i++ ){
+		float reach = mRadii[i] * 1.25f + 1.0f;
+		if( mPositions[i].y + reach < area.y1 || mPositions[i].y - reach > area.y2 ){
+			continue;
+		}
+		if( mRadii[i] != spriteRadius ){
+			spriteRadius = mRadii[i];
+			sprite = sprites.get(spriteRadius);
+		}
+		if( sprite ){
+			sprite->stamp(ctx, mPositions[i], mColors[i]);
+		} else {
+			drawDroplet(sink, i);
+		}
+	}
+}
+
+void DropletField::record(DrawSink &sink) const
+{
+	for( size_t i = 0; i < mPositions.size(); i++ ){
+		drawDroplet(sink, i);
+	}
+}
+
+void DropletField::drawDroplet(DrawSink &sink, size_t i) const
+{
+	const Vec2f &position = mPositions[i];
+	float radius = mRadii[i];
+	const Colorf &color = mColors[i];
+	Vec2f offset = Vec2f(radius * 0.05f, radius * 0.05f);
+	ColorAf shadow = ColorAf(color.r * 0.5f, color.g * 0.5f, color.b * 0.5f, 0.5f);
+	sink.setSourceRadial( position + offset, radius, position + offset, radius * 1.2f, shadow, ColorAf(shadow.r, shadow.g, shadow.b, 0) );
+	sink.circle( position + offset, radius * 1.2f );
+	sink.fill();
+	
+	sink.circle( position, radius );
+	sink.setSource( ColorAf(color.r, color.g, color.b, 1) );
+	sink.fill();
+}
+
+size_t DropletField::getMemorySize() const
+{
+	return mPositions.capacity() * sizeof(Vec2f) + mRadii.capacity() * sizeof(float) + mColors.capacity() * sizeof(Colorf);
+}
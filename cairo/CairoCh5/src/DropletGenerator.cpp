@@ -0,0 +1,140 @@
+#include "DropletGenerator.h"
+#include "Trace.h"
+#include "Philox.h"
+#include <boost/bind.hpp>
+
+DropletGenerator::DropletGenerator()
+{
+	mTable = 0;
+	mWidth = 0;
+	mHeight = 0;
+	mCellSize = 0;
+	mCount = 0;
+	mSeed = 0;
+	mReady = false;
+	mCancel = false;
+	mBusy = false;
+	mQuit = false;
+	mThread = boost::thread( boost::bind( &DropletGenerator::loop, this ) );
+}
+
+DropletGenerator::~DropletGenerator()
+{
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		mCancel = true;
+		mQuit = true;
+	}
+	mChanged.notify_all();
+	mThread.join();
+}
+
+void DropletGenerator::start(const SummedAreaTable &table, boost::shared_ptr<TiledImage> tiles, int width, int height, int cellSize, int count, uint32_t seed)
+{
+	mCancel = true;
+	wait();
+	
+	mTable = &table;
+	mTiles = tiles;
+	mWidth = width;
+	mHeight = height;
+	mCellSize = cellSize;
+	mCount = count;
+	mSeed = seed;
+	mCancel = false;
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		mReady = false;
+		mBusy = true;
+	}
+	mChanged.notify_all();
+}
+
+void DropletGenerator::wait()
+{
+	boost::mutex::scoped_lock lock(mMutex);
+	while( mBusy ){
+		mChanged.wait(lock);
+	}
+}
+
+bool DropletGenerator::publish(DropletField &field)
+{
+	boost::mutex::scoped_lock lock(mMutex);
+	if( ! mReady ){
+		return false;
+	}
+	
+	swap( field.mPositions, mPending.mPositions );
+	swap( field.mRadii, mPending.mRadii );
+	swap( field.mColors, mPending.mColors );
+	mPending.clear();
+	mReady = false;
+	return true;
+}
+
+Colorf DropletGenerator::getColor(Vec2i pixel) const
+{
+	Vec2i UL = Vec2i(pixel.x - mCellSize * 0.5f, pixel.y - mCellSize * 0.5f);
+	Vec2i LR = Vec2i(pixel.x + mCellSize * 0.5f, pixel.y + mCellSize * 0.5f);
+	
+	// both clip the cell to the image, so no bounds checks are needed here
+	if( mTiles ){
+		return mTiles->getMean( Area(UL.x, UL.y, LR.x + 1, LR.y + 1) );
+	}
+	return mTable->getAverage( Area(UL.x, UL.y, LR.x + 1, LR.y + 1) );
+}
+
+void DropletGenerator::loop()
+{
+	boost::mutex::scoped_lock lock(mMutex);
+	while( true ){
+		while( ! mBusy && ! mQuit ){
+			mChanged.wait(lock);
+		}
+		if( mQuit ){
+			return;
+		}
+		lock.unlock();
+		run();
+		lock.lock();
+		mBusy = false;
+		mReady = ! mCancel;
+		mChanged.notify_all();
+	}
+}
+
+void DropletGenerator::run()
+{
+	mPending.clear();
+	mPending.mPositions.resize(mCount);
+	mPending.mRadii.assign(mCount, mCellSize * 0.5f);
+	mPending.mColors.resize(mCount);
+	
+	// which thread builds a chunk never changes what goes in it
+	int chunkCount = ( mCount + CHUNK_SIZE - 1 ) / CHUNK_SIZE;
+	mPool.run( chunkCount, boost::bind( &DropletGenerator::generateChunk, this, _1 ) );
+}
+
+void DropletGenerator::generateChunk(size_t chunk)
+{
+	TRACE_ZONE("DropletGenerator::generateChunk");
+	// a cancelled job skips whatever chunks are left
+	if( mCancel ){
+		return;
+	}
+	// droplet i takes value i of the x stream and of the y stream, so the
+	// positions don't depend on the chunking either
+	Philox xs( mSeed, 0 ), ys( mSeed, 1 );
+	int32_t x[CHUNK_SIZE], y[CHUNK_SIZE];
+	int begin = chunk * CHUNK_SIZE;
+	int end = min( begin + CHUNK_SIZE, mCount );
+	xs.seek( begin );
+	ys.seek( begin );
+	xs.fillInt( x, end - begin, 0, mWidth );
+	ys.fillInt( y, end - begin, 0, mHeight );
+	for( int i = begin; i < end; i++ ){
+		mPending.mPositions[i] = Vec2f( x[i - begin], y[i - begin] );
+		mPending.mColors[i] = getColor( Vec2i( x[i - begin], y[i - begin] ) );
+	}
+}
@@ -0,0 +1,67 @@
+#include "DropletSprites.h"
+
+DropletSprite::DropletSprite()
+{
+	mExtent = 0;
+}
+
+DropletSprite::DropletSprite(float radius)
+{
+	// room for the shadow, which is offset by 5% and reaches 1.2 radii
+	mExtent = ceil(radius * 1.25f) + 2;
+	int size = mExtent * 2 + 1;
+	Vec2f center = Vec2f(mExtent, mExtent);
+	Vec2f offset = Vec2f(radius * 0.05f, radius * 0.05f);
+	
+	// the gradient drawDroplet() in DropletField.cpp builds per droplet, in white so it can be tinted
+	mShadow = cairo::SurfaceImage(size, size, true);
+	cairo::Context shadowCtx(mShadow);
+	cairo::GradientRadial gradient( center + offset, radius, center + offset, radius * 1.2f );
+	gradient.addColorStop(0, ColorAf(1, 1, 1, 0.5f) );
+	gradient.addColorStop(1, ColorAf(1, 1, 1, 0) );
+	shadowCtx.setSource(gradient);
+	shadowCtx.circle(center + offset, radius * 1.2f);
+	shadowCtx.fill();
+	
+	mDisc = cairo::SurfaceImage(size, size, true);
+	cairo::Context discCtx(mDisc);
+	discCtx.circle(center, radius);
+	discCtx.setSource(Colorf(1, 1, 1));
+	discCtx.fill();
+}
+
+void DropletSprite::stamp(cairo::Context &ctx, const Vec2f &position, const Colorf &color)
+{
+	double x = floor(position.x + 0.5f) - mExtent;
+	double y = floor(position.y + 0.5f) - mExtent;
+	
+	ctx.setSource(color * 0.5f);
+	ctx.maskSurface(mShadow, x, y);
+	ctx.setSource(color);
+	ctx.maskSurface(mDisc, x, y);
+}
+
+DropletSprites::DropletSprites()
+{
+}
+
+void DropletSprites::clear()
+{
+	mSprites.clear();
+}
+
+void DropletSprites::prepare(float radius)
+{
+	if( mSprites.find(radius) == mSprites.end() ){
+		mSprites[radius] = DropletSprite(radius);
+	}
+}
+
+DropletSprite* DropletSprites::get(float radius)
+{
+	map<float, DropletSprite>::iterator sprite = mSprites.find(radius);
+	if( sprite == mSprites.end() ){
+		return NULL;
+	}
+	return &sprite->second;
+}
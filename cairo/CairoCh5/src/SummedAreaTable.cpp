@@ -0,0 +1,58 @@
+#include "SummedAreaTable.h"
+
+SummedAreaTable::SummedAreaTable()
+{
+	mWidth = 0;
+	mHeight = 0;
+}
+
+void SummedAreaTable::setSource( const PlanarImage &image )
+{
+	if( image.mData == mSource.mData ){
+		return;
+	}
+	
+	mSource = image;
+	mWidth = image.mWidth;
+	mHeight = image.mHeight;
+	
+	// one extra row and column of zeros keeps getAverage free of edge cases
+	int stride = ( mWidth + 1 ) * 3;
+	mSums.assign( (size_t)stride * ( mHeight + 1 ), 0 );
+	
+	for( int y = 0; y < mHeight; y++ ){
+		uint32_t *above = &mSums[(size_t)y * stride];
+		uint32_t *sums = above + stride;
+		for( int c = 0; c < 3; c++ ){
+			const uint8_t *row = image.getRow( c, y );
+			uint32_t rowTotal = 0;
+			for( int x = 0; x < mWidth; x++ ){
+				rowTotal += row[x];
+				sums[( x + 1 ) * 3 + c] = above[( x + 1 ) * 3 + c] + rowTotal;
+			}
+		}
+	}
+}
+
+Colorf SummedAreaTable::getAverage( Area area ) const
+{
+	area.clipBy( Area( 0, 0, mWidth, mHeight ) );
+	int totalPixels = area.getWidth() * area.getHeight();
+	if( totalPixels <= 0 ){
+		return Colorf( 0, 0, 0 );
+	}
+	
+	size_t stride = ( mWidth + 1 ) * 3;
+	size_t UL = area.y1 * stride + area.x1 * 3;
+	size_t UR = area.y1 * stride + area.x2 * 3;
+	size_t LL = area.y2 * stride + area.x1 * 3;
+	size_t LR = area.y2 * stride + area.x2 * 3;
+	
+	// unsigned arithmetic wraps the same way the totals did
+	float scale = 1.0f / ( totalPixels * 255.0f );
+	float r = (uint32_t)( mSums[LR]     - mSums[LL]     - mSums[UR]     + mSums[UL]     ) * scale;
+	float g = (uint32_t)( mSums[LR + 1] - mSums[LL + 1] - mSums[UR + 1] + mSums[UL + 1] ) * scale;
+	float b = (uint32_t)( mSums[LR + 2] - mSums[LL + 2] - mSums[UR + 2] + mSums[UL + 2] ) * scale;
+	
+	return Colorf( r, g, b );
+}
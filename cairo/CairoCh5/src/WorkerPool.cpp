@@ -0,0 +1,109 @@
+#include "WorkerPool.h"
+#include <boost/bind.hpp>
+
+WorkerPool::WorkerPool(int threadCount)
+	: mBatch(0), mBusy(0), mQuit(false)
+{
+	mThreadCount = threadCount > 0 ? threadCount : max( 1, (int)boost::thread::hardware_concurrency() );
+	mRanges.reset( new Range[mThreadCount] );
+	for( int i = 0; i < mThreadCount; i++ ){
+		mRanges[i].mBegin = 0;
+		mRanges[i].mEnd = 0;
+	}
+	// worker 0 is whichever thread calls run()
+	for( int i = 1; i < mThreadCount; i++ ){
+		mThreads.create_thread( boost::bind( &WorkerPool::loop, this, i ) );
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		boost::mutex::scoped_lock lock( mMutex );
+		mQuit = true;
+	}
+	mStart.notify_all();
+	mThreads.join_all();
+}
+
+void WorkerPool::run(size_t count, TaskFn task)
+{
+	if( count == 0 ){
+		return;
+	}
+
+	// the workers are all waiting for the next batch, so the ranges are free to change
+	mTask = task;
+	for( int i = 0; i < mThreadCount; i++ ){
+		mRanges[i].mBegin = count * i / mThreadCount;
+		mRanges[i].mEnd = count * ( i + 1 ) / mThreadCount;
+	}
+	{
+		boost::mutex::scoped_lock lock( mMutex );
+		mBusy = mThreadCount - 1;
+		mBatch++;
+	}
+	mStart.notify_all();
+
+	work( 0 );
+
+	boost::mutex::scoped_lock lock( mMutex );
+	while( mBusy > 0 ){
+		mDone.wait( lock );
+	}
+}
+
+void WorkerPool::loop(int worker)
+{
+	uint32_t batch = 0;
+	for( ;; ){
+		{
+			boost::mutex::scoped_lock lock( mMutex );
+			while( ! mQuit && mBatch == batch ){
+				mStart.wait( lock );
+			}
+			if( mQuit ){
+				return;
+			}
+			batch = mBatch;
+		}
+
+		work( worker );
+
+		boost::mutex::scoped_lock lock( mMutex );
+		if( --mBusy == 0 ){
+			mDone.notify_one();
+		}
+	}
+}
+
+void WorkerPool::work(int worker)
+{
+	size_t task;
+	while( take( worker, task ) ){
+		mTask( task );
+	}
+}
+
+bool WorkerPool::take(int worker, size_t &task)
+{
+	// own range front to back, which keeps a thread on neighbouring tasks
+	{
+		Range &own = mRanges[worker];
+		boost::mutex::scoped_lock lock( own.mMutex );
+		if( own.mBegin < own.mEnd ){
+			task = own.mBegin++;
+			return true;
+		}
+	}
+	// then steal from the back of the others
+	for( int i = 1; i < mThreadCount; i++ ){
+		Range &victim = mRanges[( worker + i ) % mThreadCount];
+		boost::mutex::scoped_lock lock( victim.mMutex );
+		if( victim.mBegin < victim.mEnd ){
+			task = --victim.mEnd;
+			return true;
+		}
+	}
+	return false;
+}
@@ -1,5 +1,7 @@
 #include "cinder/app/AppBasic.h"
 #include "cinder/gl/gl.h"
+#include "InputLog.h"
+#include "Trace.h"
 using namespace ci;
 using namespace ci::app;
 using namespace std;
@@ -19,10 +21,14 @@ public:
     void keyDown( KeyEvent event );
     
     bool click;
+    
+    // P5_RECORD / P5_REPLAY input sessions, see InputLog.h
+    InputLog input;
 };
 
 void p5drawingApp::setup()
 {
+    input.setup(this);
     xyPosition = Vec2f( 200.0f, 200.0f );
     radius = 10.0f;
     gl::clear();
@@ -31,10 +37,13 @@ void p5drawingApp::setup()
 
 void p5drawingApp::update()
 {       
+    TRACE_ZONE("update");
+    input.update(this);
 }
 
 void p5drawingApp::draw()
 {    
+    TRACE_ZONE("draw");
     if(click){
         gl::drawSolidCircle( xyPosition, radius );
     }
@@ -54,6 +63,10 @@ void p5drawingApp::mouseUp( MouseEvent event )
 }
 
 void p5drawingApp::keyDown( KeyEvent event ) {
+    if( event.getCode() == KeyEvent::KEY_F1 ){
+        Trace::write();
+        return;
+    }
     if( event.getChar() == ' ' ){
         gl::clear();
     }
@@ -0,0 +1,146 @@
+#include "InputLog.h"
+#include <ctime>
+#include <cstring>
+
+static const char MAGIC[4] = { 'P', '5', 'I', 'N' };
+static const uint32_t VERSION = 1;
+
+static void writeBytes(ostream &out, uint32_t value, int bytes)
+{
+    for( int i = 0; i < bytes; i++ ){
+        out.put( (char)( ( value >> ( 8 * i ) ) & 0xff ) );
+    }
+}
+
+static uint32_t readBytes(istream &in, int bytes)
+{
+    uint32_t value = 0;
+    for( int i = 0; i < bytes; i++ ){
+        value |= (uint32_t)(uint8_t)in.get() << ( 8 * i );
+    }
+    return value;
+}
+
+InputLog::InputLog()
+    : mReplaying(false), mFrame(0), mSeed(0), mNext(0)
+{
+}
+
+InputLog::~InputLog()
+{
+    if( mRecording.is_open() ){
+        mRecording.close();
+    }
+}
+
+bool InputLog::startRecording(const string &path)
+{
+    mRecording.open( path.c_str(), ios::binary );
+    if( ! mRecording ){
+        return false;
+    }
+    mSeed = (uint32_t)time(NULL);
+    Rand::randSeed(mSeed);
+    mRecording.write( MAGIC, 4 );
+    writeBytes( mRecording, VERSION, 4 );
+    writeBytes( mRecording, mSeed, 4 );
+    mRecording.flush();
+    mFrame = 0;
+    mClock.start();
+    return true;
+}
+
+bool InputLog::startReplay(const string &path)
+{
+    ifstream in( path.c_str(), ios::binary );
+    char magic[4];
+    in.read( magic, 4 );
+    if( ! in || memcmp( magic, MAGIC, 4 ) != 0 || readBytes( in, 4 ) != VERSION ){
+        return false;
+    }
+    mSeed = readBytes( in, 4 );
+    
+    mEvents.clear();
+    while( in.peek() != EOF ){
+        Event event;
+        event.mFrame = readBytes( in, 4 );
+        event.mMillis = readBytes( in, 4 );
+        event.mType = readBytes( in, 1 );
+        event.mInitiator = readBytes( in, 1 );
+        event.mModifiers = readBytes( in, 2 );
+        event.mX = (int16_t)readBytes( in, 2 );
+        event.mY = (int16_t)readBytes( in, 2 );
+        event.mCode = readBytes( in, 2 );
+        event.mChar = (char)readBytes( in, 1 );
+        readBytes( in, 1 );
+        if( ! in ){
+            break;
+        }
+        mEvents.push_back( event );
+    }
+    
+    Rand::randSeed(mSeed);
+    mFrame = 0;
+    mNext = 0;
+    mReplaying = true;
+    return true;
+}
+
+bool InputLog::add(Type type, const MouseEvent &event)
+{
+    if( mReplaying ){
+        return true;
+    }
+    if( mRecording.is_open() ){
+        Event logged;
+        logged.mType = type;
+        logged.mInitiator = ( event.isLeft() ? MouseEvent::LEFT_DOWN : 0 ) | ( event.isRight() ? MouseEvent::RIGHT_DOWN : 0 ) | ( event.isMiddle() ? MouseEvent::MIDDLE_DOWN : 0 );
+        logged.mModifiers = ( event.isLeftDown() ? MouseEvent::LEFT_DOWN : 0 ) | ( event.isRightDown() ? MouseEvent::RIGHT_DOWN : 0 )
+            | ( event.isMiddleDown() ? MouseEvent::MIDDLE_DOWN : 0 ) | ( event.isShiftDown() ? MouseEvent::SHIFT_DOWN : 0 )
+            | ( event.isAltDown() ? MouseEvent::ALT_DOWN : 0 ) | ( event.isControlDown() ? MouseEvent::CTRL_DOWN : 0 )
+            | ( event.isMetaDown() ? MouseEvent::META_DOWN : 0 );
+        logged.mX = event.getX();
+        logged.mY = event.getY();
+        logged.mCode = 0;
+        logged.mChar = 0;
+        write( logged );
+    }
+    return false;
+}
+
+bool InputLog::add(Type type, const KeyEvent &event)
+{
+    if( mReplaying ){
+        return true;
+    }
+    if( mRecording.is_open() ){
+        Event logged;
+        logged.mType = type;
+        logged.mInitiator = 0;
+        logged.mModifiers = ( event.isShiftDown() ? KeyEvent::SHIFT_DOWN : 0 ) | ( event.isAltDown() ? KeyEvent::ALT_DOWN : 0 )
+            | ( event.isControlDown() ? KeyEvent::CTRL_DOWN : 0 ) | ( event.isMetaDown() ? KeyEvent::META_DOWN : 0 );
+        logged.mX = 0;
+        logged.mY = 0;
+        logged.mCode = event.getCode();
+        logged.mChar = event.getChar();
+        write( logged );
+    }
+    return false;
+}
+
+void InputLog::write(const Event &event)
+{
+    writeBytes( mRecording, mFrame, 4 );
+    writeBytes( mRecording, (uint32_t)( mClock.getSeconds() * 1000.0 ), 4 );
+    writeBytes( mRecording, event.mType, 1 );
+    writeBytes( mRecording, event.mInitiator, 1 );
+    writeBytes( mRecording, event.mModifiers, 2 );
+    writeBytes( mRecording, (uint16_t)event.mX, 2 );
+    writeBytes( mRecording, (uint16_t)event.mY, 2 );
+    writeBytes( mRecording, event.mCode, 2 );
+    writeBytes( mRecording, (uint8_t)event.mChar, 1 );
+    writeBytes( mRecording, 0, 1 );
+    // Cinder never deletes the app on quit, so the destructor can't be counted
+    // on to write out what is still buffered; a few events a frame is cheap to flush
+    mRecording.flush();
+}
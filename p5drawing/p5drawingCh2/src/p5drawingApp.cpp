@@ -1,5 +1,7 @@
 #include "cinder/app/AppBasic.h"
 #include "cinder/gl/gl.h"
+#include "InputLog.h"
+#include "Trace.h"
 #include "cinder/Rand.h"
 using namespace ci;
 using namespace ci::app;
@@ -28,6 +30,8 @@ public:
     Colorf color;
     Colorf colorArray[5];
     
+    // P5_RECORD / P5_REPLAY input sessions, see InputLog.h
+    InputLog input;
 };
 
 void p5drawingApp::prepareSettings( Settings *settings )
@@ -44,6 +48,7 @@ void p5drawingApp::setup()
     mouseLast = Vec2f (0.0f, 0.0f);
     
     Rand::randomize();
+    input.setup(this);
     
     for (int i = 0; i < 5; i++) {
         colorArray[i].r = Rand::randFloat(1.0);
@@ -56,6 +61,8 @@ void p5drawingApp::setup()
 
 void p5drawingApp::update()
 {       
+    TRACE_ZONE("update");
+    input.update(this);
     mouseVelocity = xyPosition - mouseLast;
     radius = 2.0f + abs(mouseVelocity.x) + abs(mouseVelocity.y);
     if(radius > 50){
@@ -66,6 +73,7 @@ void p5drawingApp::update()
 
 void p5drawingApp::draw()
 {   
+    TRACE_ZONE("draw");
     gl::color( color );
     if(click){
         gl::drawSolidCircle( xyPosition, radius );
@@ -89,6 +97,10 @@ void p5drawingApp::mouseUp( MouseEvent event )
 }
 
 void p5drawingApp::keyDown( KeyEvent event ) {
+    if( event.getCode() == KeyEvent::KEY_F1 ){
+        Trace::write();
+        return;
+    }
     if( event.getChar() == ' ' ){
         gl::clear();
     }
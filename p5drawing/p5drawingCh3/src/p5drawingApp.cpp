@@ -1,5 +1,7 @@
 #include "cinder/app/AppBasic.h"
 #include "cinder/gl/gl.h"
+#include "InputLog.h"
+#include "Trace.h"
 #include<list>
 #include "cinder/CinderMath.h"
 using namespace ci;
@@ -13,6 +15,7 @@ public:
     void draw();
     
     void mouseMove(MouseEvent event);
+    void keyDown(KeyEvent event);
     
     Vec2f mousePos, mouseLast, mouseDir, mouseDirPlus, mouseDirMinus;
     Vec3f vStart, vEnd, vEndPlus, vEndMinus; 
@@ -22,6 +25,9 @@ public:
     int valAverageCount;
     
     float angleOrig, anglePlus, angleMinus, perpLength;
+    
+    // P5_RECORD / P5_REPLAY input sessions, see InputLog.h
+    InputLog input;
 };
 
 void p5drawingApp::mouseMove(MouseEvent event)
@@ -29,8 +35,16 @@ void p5drawingApp::mouseMove(MouseEvent event)
     mousePos = event.getPos();
 }
 
+void p5drawingApp::keyDown(KeyEvent event)
+{
+    if( event.getCode() == KeyEvent::KEY_F1 ){
+        Trace::write();
+    }
+}
+
 void p5drawingApp::setup()
 {       
+    input.setup(this);
     gl::clear( );
     valAverageCount = 5;
     vStart = Vec3f(0.0f, 0.0f, 0.0f);
@@ -46,6 +60,8 @@ void p5drawingApp::setup()
 
 void p5drawingApp::update()
 {
+    TRACE_ZONE("update");
+    input.update(this);
     mouseDir = mousePos - mouseLast;
     if( abs(mouseDir.x) + abs(mouseDir.y) > 2.0f ){
         mouseDir.safeNormalize();
@@ -101,6 +117,7 @@ void p5drawingApp::update()
 
 void p5drawingApp::draw()
 {
+    TRACE_ZONE("draw");
     gl::clear( );
     gl::color( Colorf(1.0f, 1.0f, 1.0f) );
     gl::drawVector( vStart, vEnd, vWidth, vRadius);
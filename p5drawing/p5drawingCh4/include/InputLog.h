@@ -0,0 +1,104 @@
+#pragma once
+#include "cinder/app/AppBasic.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+#include <fstream>
+#include <cstdlib>
+#include <vector>
+#include <string>
+
+using namespace ci;
+using namespace ci::app;
+using namespace std;
+
+// Records the mouse and key events an app receives to a compact binary file,
+// or plays a recording back on the same frames the events first arrived on.
+// Launch with P5_RECORD or P5_REPLAY set to a file path to turn it on. Recording
+// pins the Rand seed and stores it in the file, so Rand draws after setup come out
+// the same on replay. Live input is ignored while a replay runs.
+// Apps call setup(this) in setup(), before drawing any random numbers, and
+// update(this) first thing in update().
+//
+// File layout, little endian: "P5IN", version, seed, then 20 bytes per event:
+// frame, milliseconds since recording started (both uint32), type, mouse initiator
+// (uint8), modifiers, x, y, key code (16 bit each), key char (8 bit) and one pad byte.
+class InputLog {
+public:
+    enum Type { MOUSE_DOWN, MOUSE_UP, MOUSE_MOVE, MOUSE_DRAG, KEY_DOWN, KEY_UP };
+    
+    struct Event {
+        uint32_t mFrame, mMillis;
+        uint8_t mType, mInitiator;
+        uint16_t mModifiers;
+        int16_t mX, mY;
+        uint16_t mCode;
+        char mChar;
+        
+        MouseEvent getMouseEvent() const { return MouseEvent(mInitiator, mX, mY, mModifiers, 0.0f, 0); }
+        KeyEvent getKeyEvent() const { return KeyEvent(mCode, mChar, mModifiers, 0); }
+    };
+    
+    InputLog();
+    ~InputLog();
+    
+    template<typename T>
+    void setup(T *app)
+    {
+        if( getenv("P5_REPLAY") ){
+            startReplay( getenv("P5_REPLAY") );
+        } else if( getenv("P5_RECORD") ){
+            startRecording( getenv("P5_RECORD") );
+        }
+#if ! defined( HEADLESS )
+        app->registerMouseDown( this, &InputLog::mouseDown );
+        app->registerMouseUp( this, &InputLog::mouseUp );
+        app->registerMouseMove( this, &InputLog::mouseMove );
+        app->registerMouseDrag( this, &InputLog::mouseDrag );
+        app->registerKeyDown( this, &InputLog::keyDown );
+        app->registerKeyUp( this, &InputLog::keyUp );
+#endif
+    }
+    
+    // Hands app the recorded events of the coming frame
+    template<typename T>
+    void update(T *app)
+    {
+        while( mReplaying && mNext < mEvents.size() && mEvents[mNext].mFrame <= mFrame ){
+            const Event &event = mEvents[mNext++];
+            switch( event.mType ){
+                case MOUSE_DOWN: app->mouseDown( event.getMouseEvent() ); break;
+                case MOUSE_UP: app->mouseUp( event.getMouseEvent() ); break;
+                case MOUSE_MOVE: app->mouseMove( event.getMouseEvent() ); break;
+                case MOUSE_DRAG: app->mouseDrag( event.getMouseEvent() ); break;
+                case KEY_DOWN: app->keyDown( event.getKeyEvent() ); break;
+                case KEY_UP: app->keyUp( event.getKeyEvent() ); break;
+            }
+        }
+        if( mReplaying && mNext == mEvents.size() ){
+            mReplaying = false;
+        }
+        mFrame++;
+    }
+    
+    bool startRecording(const string &path);
+    bool startReplay(const string &path);
+    
+    // registered with the app; they log live events, or swallow them during a replay
+    bool mouseDown(MouseEvent event) { return add(MOUSE_DOWN, event); }
+    bool mouseUp(MouseEvent event) { return add(MOUSE_UP, event); }
+    bool mouseMove(MouseEvent event) { return add(MOUSE_MOVE, event); }
+    bool mouseDrag(MouseEvent event) { return add(MOUSE_DRAG, event); }
+    bool keyDown(KeyEvent event) { return add(KEY_DOWN, event); }
+    bool keyUp(KeyEvent event) { return add(KEY_UP, event); }
+    
+    bool add(Type type, const MouseEvent &event);
+    bool add(Type type, const KeyEvent &event);
+    void write(const Event &event);
+    
+    bool mReplaying;
+    uint32_t mFrame, mSeed;
+    vector<Event> mEvents;
+    size_t mNext;
+    ofstream mRecording;
+    Timer mClock;
+};
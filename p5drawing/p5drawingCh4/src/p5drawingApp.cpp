@@ -1,8 +1,11 @@
 #include "cinder/app/AppBasic.h"
 #include "cinder/gl/gl.h"
+#include "InputLog.h"
+#include "Trace.h"
 #include<list>
 #include "cinder/CinderMath.h"
 #include "cinder/Rand.h"
+#include "Philox.h"
 using namespace ci;
 using namespace ci::app;
 using namespace std;
@@ -26,6 +29,11 @@ public:
     
     float angleOrig, anglePlus, angleMinus, perpLength;
     Colorf color;
+    // draws the stroke colors; seeded from Rand after input.setup so recordings replay the same colors
+    Philox random;
+    
+    // P5_RECORD / P5_REPLAY input sessions, see InputLog.h
+    InputLog input;
 };
 
 void p5drawingApp::mouseUp(MouseEvent event)
@@ -37,6 +45,10 @@ void p5drawingApp::mouseUp(MouseEvent event)
 
 void p5drawingApp::keyDown(KeyEvent event)
 {
+    if( event.getCode() == KeyEvent::KEY_F1 ){
+        Trace::write();
+        return;
+    }
     if( event.getChar() == ' ' ){
         gl::clear();
     }
@@ -49,6 +61,8 @@ void p5drawingApp::mouseDrag(MouseEvent event)
 
 void p5drawingApp::setup()
 {       
+    input.setup(this);
+    random = Philox( Rand::randInt() );
     gl::clear( );
     valAverageCount = 5;
     vStart = Vec3f(0.0f, 0.0f, 0.0f);
@@ -58,9 +72,11 @@ void p5drawingApp::setup()
 
 void p5drawingApp::update()
 {   
-    color.r = Rand::randFloat();
-    color.g = Rand::randFloat();
-    color.b = Rand::randFloat();
+    TRACE_ZONE("update");
+    input.update(this);
+    float rgb[3];
+    random.fillFloat( rgb, 3 );
+    color = Colorf( rgb[0], rgb[1], rgb[2] );
     
     mouseDir = mousePos - mouseLast;
     if( abs(mouseDir.x) + abs(mouseDir.y) > 2.0f ){
@@ -120,6 +136,7 @@ void p5drawingApp::update()
 
 void p5drawingApp::draw()
 {   
+    TRACE_ZONE("draw");
     glLineWidth(perpLength/5);
     gl::color( color );
     if(vectorValues.size() == valAverageCount){
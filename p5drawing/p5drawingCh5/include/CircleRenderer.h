@@ -0,0 +1,61 @@
+#pragma once
+#include "cinder/gl/gl.h"
+#include "cinder/gl/GlslProg.h"
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+// only Windows needs a calling convention on GL entry points
+#if ! defined( APIENTRY )
+    #define APIENTRY
+#endif
+
+using namespace ci;
+using namespace std;
+
+// Draws any number of circles with one draw call. Every frame the instances
+// (center, radius and color) go into a single streaming vertex buffer, and one
+// glDrawArraysInstancedARB call draws a unit triangle fan per instance, moved
+// and scaled into place by the vertex shader. Where instancing is missing
+// (it needs GLSL plus ARB_instanced_arrays and ARB_draw_instanced) the fans are
+// expanded into plain triangles on the CPU and drawn with one glDrawArrays.
+// Needs a current GL context from the first draw() on.
+class CircleRenderer : private boost::noncopyable {
+public:
+    // triangles per circle
+    static const int SEGMENTS = 16;
+    
+    struct Instance {
+        float mX, mY, mRadius;
+        uint8_t mColor[4];
+    };
+    
+    CircleRenderer();
+    ~CircleRenderer();
+    
+    // Draws mInstances in the window's coordinates
+    void draw();
+    // false when draw() falls back to expanded triangles; only known after the first draw()
+    bool isInstanced() const { return mInstanced; }
+    
+    void setup();
+    void drawInstanced();
+    void drawExpanded();
+    
+    // filled in by the caller before every draw()
+    vector<Instance> mInstances;
+    
+    bool mSetup, mInstanced;
+    // unit circle fan: the center, then SEGMENTS + 1 points around the edge
+    vector<Vec2f> mFan;
+    
+    gl::GlslProg mShader;
+    GLuint mFanBuffer, mInstanceBuffer;
+    typedef void (APIENTRY *VertexAttribDivisorFn)(GLuint index, GLuint divisor);
+    typedef void (APIENTRY *DrawArraysInstancedFn)(GLenum mode, GLint first, GLsizei count, GLsizei instances);
+    VertexAttribDivisorFn mVertexAttribDivisor;
+    DrawArraysInstancedFn mDrawArraysInstanced;
+    
+    // fallback vertex and color arrays, three vertices per triangle
+    vector<Vec2f> mVertices;
+    vector<uint32_t> mColors;
+};
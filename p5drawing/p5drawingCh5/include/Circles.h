@@ -0,0 +1,126 @@
+#pragma once
+#include "cinder/Vector.h"
+#include "WorkerPool.h"
+#include "CircleRenderer.h"
+#include "SpatialGrid.h"
+#include <boost/noncopyable.hpp>
+
+using namespace ci;
+using namespace std;
+
+// Every bouncing circle, stored as structure of arrays: one 16 byte aligned
+// array per field, so update() can load four circles' worth of a field at once
+// and run the bounce, damping and gravity step on them with SSE2. The scalar
+// path handles the remainder and gives the same results bit for bit.
+// Gravity only ever pulls down, so only its y component is stored.
+//
+// A circle slower than the sleep speed for SLEEP_FRAMES frames in a row falls
+// asleep once it rests on something that can't move: the bottom edge or
+// another sleeper. It leaves these arrays for the compact mSleeping ones, skips
+// update and collide, and is drawn from SleepLayer's cached picture. Awake
+// circles bounce off sleepers as if they were fixed; one that hits a sleeper
+// hard enough wakes it, and a sleeper whose support has gone wakes and falls.
+class Circles : private boost::noncopyable {
+public:
+    // circles per task of a parallel update; all the arrays of a chunk fit in L2
+    static const size_t CHUNK_SIZE = 4096;
+    // frames below the sleep speed (see Circles.cpp) before a circle sleeps
+    static const int SLEEP_FRAMES = 30;
+    // mWakeRequests entry of a circle that woke nobody
+    static const uint32_t NO_WAKE = 0xffffffff;
+    
+    Circles();
+    ~Circles();
+    
+    // Launches a circle up and to the right from position; variation, around 1,
+    // scales its launch speed, gravity and bounce damping
+    void add(Vec2f position, float variation);
+    // Moves every circle one step, bouncing off the edges of a window of windowSize
+    void update(Vec2i windowSize);
+    // The same, split into chunks across pool. Circles don't interact, so this
+    // comes out bit for bit the same as the serial update.
+    void update(Vec2i windowSize, WorkerPool &pool);
+    // Pushes overlapping circles apart and bounces them off each other. Every
+    // circle is resolved against where its neighbours were before the call and
+    // writes only itself, so the result doesn't depend on order or threads.
+    // Afterwards the circles are stored in grid order, so circles near each
+    // other are near each other in memory and the next frame's build, gather
+    // and neighbour reads mostly walk the arrays in order.
+    void collide(Vec2i windowSize);
+    void collide(Vec2i windowSize, WorkerPool &pool);
+    // Puts circles that have been still long enough to sleep, wakes the
+    // sleepers the last collide() hit hard enough and the ones left without
+    // support, and retires the oldest sleepers once there are mMaxCircles
+    // circles. Call after update() and collide().
+    void sleep(Vec2i windowSize);
+    // Every sleeper back into the simulation at rest, for when the window changes
+    void wakeAll();
+    // one gl::drawSolidCircle per awake circle
+    void draw();
+    // every awake circle in one draw call, see CircleRenderer
+    void draw(CircleRenderer &renderer);
+    // sleepers from begin on
+    void drawSleeping(CircleRenderer &renderer, size_t begin);
+    
+    size_t size() const { return mCount; }
+    // awake and sleeping circles, what mMaxCircles caps
+    size_t getTotal() const { return mCount + mSleepingX.size(); }
+    void reserve(size_t capacity);
+    
+    // circles in [begin, end), four at a time where possible
+    void updateRange(size_t begin, size_t end, float width, float height);
+    void updateChunk(size_t chunk, float width, float height);
+    // the same step one circle at a time
+    void updateScalar(size_t begin, size_t end, float width, float height);
+    // bumps the still counters of circles in [begin, end) and returns the highest
+    float countStill(size_t begin, size_t end);
+    float countStillScalar(size_t begin, size_t end);
+    // copies circle from to slot to, still counter included
+    void move(size_t from, size_t to);
+    // whether a circle at x, y rests on the bottom edge or on a sleeper below it
+    bool isSupported(float x, float y, float height) const;
+    // copies positions and velocities of grid slots [begin, end) into cell order
+    void gatherRange(size_t begin, size_t end);
+    void gatherChunk(size_t chunk);
+    // resolves the circles in grid slots [begin, end)
+    void collideRange(size_t begin, size_t end);
+    void collideChunk(size_t chunk);
+    // copies the fields collide doesn't touch of grid slots [begin, end) into
+    // cell order, into the sorted arrays collideRange is done with
+    void reorderRange(size_t begin, size_t end);
+    void reorderChunk(size_t chunk);
+    // makes the collision results, in grid order, the live arrays
+    void swapResolved();
+    
+    float mRadius;
+    size_t mCount, mCapacity;
+    float *mX, *mY, *mVelocityX, *mVelocityY, *mGravity, *mVariation;
+    // frames in a row each circle has been below the sleep speed, as floats so
+    // sleep() counts them four at a time like update()
+    float *mStillFrames;
+    
+    // cells one diameter across, so every circle a circle can touch is in the 3x3 cells around it
+    SpatialGrid mGrid;
+    // positions and velocities in the grid's order, so a neighbour query reads
+    // three contiguous runs instead of jumping around the arrays; once every
+    // circle is resolved, reorderRange() reuses three of them
+    float *mSortedX, *mSortedY, *mSortedVelocityX, *mSortedVelocityY;
+    float *mResolvedX, *mResolvedY, *mResolvedVelocityX, *mResolvedVelocityY;
+    
+    // per awake circle, the sleeper the last collide() woke, or NO_WAKE
+    vector<uint32_t> mWakeRequests;
+    // Sleepers need no velocity, and their gravity follows from the variation.
+    // Circles fall asleep onto the end, so the oldest come first.
+    vector<float> mSleepingX, mSleepingY, mSleepingVariation;
+    SpatialGrid mSleepingGrid;
+    // set whenever a sleeper leaves the sleeping set, cleared by SleepLayer once it has redrawn them
+    bool mSleepingRemoved;
+    // set when sleepers left in the last sleep(), so the next checks what the rest rest on
+    bool mSupportLost;
+    // With mMaxCircles above 0, sleep() retires the oldest sleepers once awake
+    // and sleeping circles reach it, down to three quarters of it if there are
+    // sleepers enough. Retired circles are removed for good, from the screen
+    // too, and whatever rested on them falls. Awake circles are never retired,
+    // so callers that add circles should keep getTotal() under the cap.
+    size_t mMaxCircles;
+};
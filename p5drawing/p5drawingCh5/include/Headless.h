@@ -0,0 +1,84 @@
+#pragma once
+#include "cinder/ImageIo.h"
+// a headless build has no window and links no app framework, so only the event types come along
+#if defined( HEADLESS )
+#include "cinder/app/KeyEvent.h"
+#include "cinder/app/MouseEvent.h"
+#else
+#include "cinder/app/AppBasic.h"
+#endif
+#include "FrameStats.h"
+#include <string>
+#include <vector>
+#include <iostream>
+
+using namespace ci;
+using namespace ci::app;
+using namespace std;
+
+// Apps derive from AppBase and end with CINDER_APP instead of CINDER_APP_BASIC.
+// Normally that is just AppBasic. Built with HEADLESS defined and linked
+// against OSMesa, as the Headless configuration of the xcode project does
+// (set OSMESA_PATH to where OSMesa is installed), the app gets no window:
+// main() renders into a software OpenGL context. OSMesa has to come before
+// OpenGL.framework on the link line, so every gl call binds to it rather than
+// to a framework with no current context; benchmark.sh checks with nm -m.
+// Each run goes through setup, then update and draw for a fixed number of
+// frames, optionally writing each frame out as a png. Run it as
+//   app [--frames 300] [--size 640x480] [--dump directory]
+//       [--warmup 0] [--bench results.json] [--name scenario] [app options]
+// Time advances a fixed 1/60s per frame so runs are repeatable. With --bench,
+// update and draw are timed for every frame after the warmup frames and their
+// percentiles appended to the file, see FrameStats. Draw times include glFinish.
+#if defined( HEADLESS )
+
+class HeadlessApp {
+public:
+    HeadlessApp();
+    virtual ~HeadlessApp() {}
+    
+    virtual void setup() {}
+    virtual void update() {}
+    virtual void draw() {}
+    virtual void shutdown() {}
+    // Options the runner does not know are passed here in command-line order,
+    // before setup; return false to reject one
+    virtual bool setOption(const string &name, const string &value) { return false; }
+    // only ever called by a replayed InputLog
+    virtual void mouseDown(MouseEvent event) {}
+    virtual void mouseUp(MouseEvent event) {}
+    virtual void mouseMove(MouseEvent event) {}
+    virtual void mouseDrag(MouseEvent event) {}
+    virtual void keyDown(KeyEvent event) {}
+    virtual void keyUp(KeyEvent event) {}
+    
+    int getWindowWidth() const { return mWidth; }
+    int getWindowHeight() const { return mHeight; }
+    Vec2i getWindowSize() const { return Vec2i(mWidth, mHeight); }
+    Area getWindowBounds() const { return Area(0, 0, mWidth, mHeight); }
+    uint32_t getElapsedFrames() const { return mFrame; }
+    double getElapsedSeconds() const { return mFrame / 60.0; }
+    ostream& console() { return cout; }
+    
+    // Parses the command line, then drives app and deletes it
+    static int run(HeadlessApp *app, int argc, char *argv[]);
+    void dumpFrame();
+    
+    int mWidth, mHeight;
+    uint32_t mFrame, mFrames, mWarmup;
+    string mBenchPath, mName;
+    FrameStats mStats;
+    string mDumpDirectory;
+    // the OSMesa color buffer, RGBA rows top to bottom
+    vector<uint8_t> mPixels;
+};
+
+typedef HeadlessApp AppBase;
+#define CINDER_APP( APP, RENDERER ) int main(int argc, char *argv[]) { return HeadlessApp::run(new APP, argc, argv); }
+
+#else
+
+typedef AppBasic AppBase;
+#define CINDER_APP( APP, RENDERER ) CINDER_APP_BASIC( APP, RENDERER )
+
+#endif
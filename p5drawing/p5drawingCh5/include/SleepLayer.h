@@ -0,0 +1,29 @@
+#pragma once
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Fbo.h"
+#include "Circles.h"
+#include "CircleRenderer.h"
+
+using namespace ci;
+using namespace std;
+
+// The sleeping circles as a picture. Circles that fall asleep are drawn into
+// a window sized Fbo once, and from then on every frame draws that Fbo's
+// texture instead of the circles themselves. The picture is only redrawn from
+// scratch when a sleeper leaves: woken, retired, or the window resized.
+class SleepLayer {
+public:
+    SleepLayer();
+    
+    // Brings the picture up to date with circles' sleepers and draws it over the whole window
+    void draw(Circles &circles, CircleRenderer &renderer, Vec2i windowSize);
+    
+    void bind(gl::Fbo &fbo);
+    void unbind(gl::Fbo &fbo, Vec2i windowSize);
+    // mLayer's texture as one quad covering the window
+    void drawTexture(Vec2i windowSize);
+    
+    gl::Fbo mLayer;
+    // sleepers already in mLayer
+    size_t mDrawn;
+};
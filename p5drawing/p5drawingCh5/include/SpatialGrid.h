@@ -0,0 +1,61 @@
+#pragma once
+#include "WorkerPool.h"
+#include <vector>
+#include <stdint.h>
+#include <cstddef>
+
+using namespace std;
+
+// Uniform grid over the window, rebuilt from scratch every frame. build()
+// bins the points with a counting sort in two passes, so neither pass
+// scatters across the whole grid: the first sorts the points into bands of
+// BAND_ROWS rows, the second sorts each band's points into its cells. Both
+// are stable, so every cell holds its points in index order, and the result
+// is the same whether the passes run on one thread or are split across a
+// pool: points in chunks of CHUNK_SIZE for the first, bands for the second.
+// Cells are stored row by row, so the three cells of a row next to each other
+// are one contiguous run of mIndices, and a neighbour query is three runs.
+class SpatialGrid {
+public:
+    // points per task of the band pass
+    static const size_t CHUNK_SIZE = 16384;
+    // rows per band; a band's cells and points stay in cache while it is sorted
+    static const int BAND_ROWS = 16;
+    
+    SpatialGrid();
+    
+    // Bins count points into square cells of cellSize covering width x height;
+    // points outside go into the nearest border cell
+    void build(const float *x, const float *y, size_t count, float width, float height, float cellSize);
+    // The same, split across pool
+    void build(const float *x, const float *y, size_t count, float width, float height, float cellSize, WorkerPool &pool);
+    
+    int getColumn(float x) const;
+    int getRow(float y) const;
+    // Points in the cell holding (x, y) and the eight around it, as up to three
+    // runs [begin[k], end[k]) of mIndices, one per row; returns the run count
+    int getNeighbors(float x, float y, uint32_t begin[3], uint32_t end[3]) const;
+    
+    // sizes the grid and the scratch for count points
+    void prepare(size_t count, float width, float height, float cellSize);
+    // first pass: every point's cell, and how many points each chunk has per band
+    void countChunk(size_t chunk, const float *x, const float *y);
+    // turns the chunk counts into band starts and per chunk write positions
+    void sumBands();
+    // writes the chunk's points into mBanded, band by band
+    void scatterChunk(size_t chunk);
+    // second pass: the band's points into its cells' slices of mIndices
+    void sortBand(size_t band);
+    
+    float mCellSize;
+    int mColumns, mRows;
+    // mColumns * mRows + 1 offsets into mIndices; cell c holds mStarts[c] to mStarts[c + 1]
+    vector<uint32_t> mStarts;
+    vector<uint32_t> mIndices;
+    // scratch for build(): every point's cell, every cell's write position,
+    // the points in band order, and per chunk and band counts, then write positions
+    size_t mCount, mChunks, mBands;
+    vector<uint32_t> mCells, mNext, mBanded, mChunkBands;
+    // mBands + 1 offsets into mBanded
+    vector<uint32_t> mBandStarts;
+};
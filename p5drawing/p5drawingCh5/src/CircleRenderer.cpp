@@ -0,0 +1,184 @@
+#include "CircleRenderer.h"
+#include "Trace.h"
+#include <cstring>
+#include <cstddef>
+#include <cmath>
+
+#if defined( HEADLESS )
+    #include <GL/osmesa.h>
+#elif defined( CINDER_MAC )
+    #include <dlfcn.h>
+#elif defined( __linux__ )
+    #include <GL/glx.h>
+#endif
+
+// attribute locations, bound before the shader is linked again
+static const GLuint CORNER = 0;
+static const GLuint INSTANCE = 1;
+static const GLuint COLOR = 2;
+
+static const char *VERTEX_SHADER =
+    "#version 120\n"
+    "attribute vec2 corner;\n"
+    "attribute vec3 instance;\n"
+    "attribute vec4 color;\n"
+    "varying vec4 vColor;\n"
+    "void main() {\n"
+    "    vColor = color;\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix * vec4( instance.xy + corner * instance.z, 0.0, 1.0 );\n"
+    "}\n";
+
+static const char *FRAGMENT_SHADER =
+    "#version 120\n"
+    "varying vec4 vColor;\n"
+    "void main() {\n"
+    "    gl_FragColor = vColor;\n"
+    "}\n";
+
+// extension entry points are not exported the same way everywhere
+static void* getProc(const char *name)
+{
+#if defined( HEADLESS )
+    return (void*)OSMesaGetProcAddress( name );
+#elif defined( CINDER_MAC )
+    return dlsym( RTLD_DEFAULT, name );
+#elif defined( CINDER_MSW )
+    return (void*)wglGetProcAddress( name );
+#elif defined( __linux__ )
+    return (void*)glXGetProcAddressARB( (const GLubyte*)name );
+#else
+    return 0;
+#endif
+}
+
+CircleRenderer::CircleRenderer()
+    : mSetup(false), mInstanced(false), mFanBuffer(0), mInstanceBuffer(0), mVertexAttribDivisor(0), mDrawArraysInstanced(0)
+{
+    mFan.push_back( Vec2f(0.0f, 0.0f) );
+    for( int i = 0; i <= SEGMENTS; i++ ){
+        float angle = i * 2.0f * (float)M_PI / SEGMENTS;
+        mFan.push_back( Vec2f(cos(angle), sin(angle)) );
+    }
+}
+
+CircleRenderer::~CircleRenderer()
+{
+    if( mFanBuffer ){
+        glDeleteBuffers( 1, &mFanBuffer );
+        glDeleteBuffers( 1, &mInstanceBuffer );
+    }
+}
+
+void CircleRenderer::setup()
+{
+    mSetup = true;
+    mVertexAttribDivisor = (VertexAttribDivisorFn)getProc( "glVertexAttribDivisorARB" );
+    mDrawArraysInstanced = (DrawArraysInstancedFn)getProc( "glDrawArraysInstancedARB" );
+    if( ! gl::isExtensionAvailable( "GL_ARB_instanced_arrays" ) || ! gl::isExtensionAvailable( "GL_ARB_draw_instanced" )
+        || ! mVertexAttribDivisor || ! mDrawArraysInstanced ){
+        return;
+    }
+
+    try {
+        mShader = gl::GlslProg( VERTEX_SHADER, FRAGMENT_SHADER );
+    }
+    catch( gl::GlslProgCompileExc & ){
+        return;
+    }
+    GLuint program = mShader.getHandle();
+    glBindAttribLocation( program, CORNER, "corner" );
+    glBindAttribLocation( program, INSTANCE, "instance" );
+    glBindAttribLocation( program, COLOR, "color" );
+    glLinkProgram( program );
+    GLint linked = 0;
+    glGetProgramiv( program, GL_LINK_STATUS, &linked );
+    if( ! linked ){
+        return;
+    }
+
+    glGenBuffers( 1, &mFanBuffer );
+    glGenBuffers( 1, &mInstanceBuffer );
+    glBindBuffer( GL_ARRAY_BUFFER, mFanBuffer );
+    glBufferData( GL_ARRAY_BUFFER, mFan.size() * sizeof(Vec2f), &mFan[0], GL_STATIC_DRAW );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+    mInstanced = true;
+}
+
+void CircleRenderer::draw()
+{
+    TRACE_ZONE("CircleRenderer::draw");
+    if( ! mSetup ){
+        setup();
+    }
+    if( mInstances.empty() ){
+        return;
+    }
+    if( mInstanced ){
+        drawInstanced();
+    } else {
+        drawExpanded();
+    }
+}
+
+void CircleRenderer::drawInstanced()
+{
+    // respecifying the whole buffer lets the driver hand out fresh storage
+    // instead of waiting for last frame's draw to finish reading the old one
+    glBindBuffer( GL_ARRAY_BUFFER, mInstanceBuffer );
+    glBufferData( GL_ARRAY_BUFFER, mInstances.size() * sizeof(Instance), NULL, GL_STREAM_DRAW );
+    glBufferSubData( GL_ARRAY_BUFFER, 0, mInstances.size() * sizeof(Instance), &mInstances[0] );
+    glVertexAttribPointer( INSTANCE, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (const GLvoid*)offsetof(Instance, mX) );
+    glVertexAttribPointer( COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Instance), (const GLvoid*)offsetof(Instance, mColor) );
+    glEnableVertexAttribArray( INSTANCE );
+    glEnableVertexAttribArray( COLOR );
+    mVertexAttribDivisor( INSTANCE, 1 );
+    mVertexAttribDivisor( COLOR, 1 );
+
+    glBindBuffer( GL_ARRAY_BUFFER, mFanBuffer );
+    glVertexAttribPointer( CORNER, 2, GL_FLOAT, GL_FALSE, sizeof(Vec2f), 0 );
+    glEnableVertexAttribArray( CORNER );
+
+    mShader.bind();
+    mDrawArraysInstanced( GL_TRIANGLE_FAN, 0, (GLsizei)mFan.size(), (GLsizei)mInstances.size() );
+    mShader.unbind();
+
+    // divisors stick to the attribute index, so put them back for anyone else
+    mVertexAttribDivisor( INSTANCE, 0 );
+    mVertexAttribDivisor( COLOR, 0 );
+    glDisableVertexAttribArray( CORNER );
+    glDisableVertexAttribArray( INSTANCE );
+    glDisableVertexAttribArray( COLOR );
+    glBindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+
+void CircleRenderer::drawExpanded()
+{
+    size_t vertexCount = mInstances.size() * SEGMENTS * 3;
+    mVertices.resize( vertexCount );
+    mColors.resize( vertexCount );
+
+    Vec2f *vertex = &mVertices[0];
+    uint32_t *color = &mColors[0];
+    for( size_t i = 0; i < mInstances.size(); i++ ){
+        const Instance &instance = mInstances[i];
+        Vec2f center( instance.mX, instance.mY );
+        uint32_t rgba;
+        memcpy( &rgba, instance.mColor, 4 );
+        for( int s = 1; s <= SEGMENTS; s++ ){
+            *vertex++ = center;
+            *vertex++ = center + mFan[s] * instance.mRadius;
+            *vertex++ = center + mFan[s + 1] * instance.mRadius;
+        }
+        for( int v = 0; v < SEGMENTS * 3; v++ ){
+            *color++ = rgba;
+        }
+    }
+
+    glEnableClientState( GL_VERTEX_ARRAY );
+    glEnableClientState( GL_COLOR_ARRAY );
+    glVertexPointer( 2, GL_FLOAT, 0, &mVertices[0] );
+    glColorPointer( 4, GL_UNSIGNED_BYTE, 0, &mColors[0] );
+    glDrawArrays( GL_TRIANGLES, 0, (GLsizei)vertexCount );
+    glDisableClientState( GL_COLOR_ARRAY );
+    glDisableClientState( GL_VERTEX_ARRAY );
+}
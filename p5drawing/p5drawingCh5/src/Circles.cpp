@@ -0,0 +1,615 @@
+#include "Circles.h"
+#include "cinder/gl/gl.h"
+#include "Trace.h"
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <boost/bind.hpp>
+
+// share of the closing speed two circles keep when they hit, like the 0.8 off the walls
+static const float RESTITUTION = 0.8f;
+// Share of its speed a circle keeps for every frame it touches another. In a
+// pile every circle touches several every frame, so their jitter dies down
+// under the sleep speed instead of going on forever.
+static const float CONTACT_DAMPING = 0.8f;
+// Pixels per frame. A circle resting on the bottom edge still picks up one
+// frame of gravity, about 0.15, before the edge stops it again, and circles
+// in a pile jitter a little faster than that as they push each other apart.
+static const float SLEEP_SPEED = 0.75f;
+// a hit has to be this fast to wake a sleeper, so a pile's own jitter doesn't
+static const float WAKE_SPEED = 1.5f;
+// Pixels. A circle resting on a sleeper is pushed out to exactly touching it,
+// and then falls back in a little, so support allows for a gap either way.
+static const float SUPPORT_GAP = 1.0f;
+
+#if defined( __SSE2__ ) || defined( _M_IX86 ) || defined( _M_X64 )
+    #define CIRCLES_SSE2
+    #include <emmintrin.h>
+#endif
+
+static float* allocate(size_t count)
+{
+#if defined( CIRCLES_SSE2 )
+    return (float*)_mm_malloc( count * sizeof(float), 16 );
+#else
+    return (float*)malloc( count * sizeof(float) );
+#endif
+}
+
+static void release(float *data)
+{
+#if defined( CIRCLES_SSE2 )
+    _mm_free( data );
+#else
+    free( data );
+#endif
+}
+
+static void grow(float *&data, size_t count, size_t capacity)
+{
+    float *grown = allocate( capacity );
+    if( count > 0 ){
+        memcpy( grown, data, count * sizeof(float) );
+    }
+    release( data );
+    data = grown;
+}
+
+Circles::Circles()
+    : mRadius(5.0f), mCount(0), mCapacity(0), mX(0), mY(0), mVelocityX(0), mVelocityY(0), mGravity(0), mVariation(0), mStillFrames(0),
+      mSortedX(0), mSortedY(0), mSortedVelocityX(0), mSortedVelocityY(0),
+      mResolvedX(0), mResolvedY(0), mResolvedVelocityX(0), mResolvedVelocityY(0),
+      mSleepingRemoved(false), mSupportLost(false), mMaxCircles(0)
+{
+}
+
+Circles::~Circles()
+{
+    release( mX );
+    release( mY );
+    release( mVelocityX );
+    release( mVelocityY );
+    release( mGravity );
+    release( mVariation );
+    release( mStillFrames );
+    release( mSortedX );
+    release( mSortedY );
+    release( mSortedVelocityX );
+    release( mSortedVelocityY );
+    release( mResolvedX );
+    release( mResolvedY );
+    release( mResolvedVelocityX );
+    release( mResolvedVelocityY );
+}
+
+void Circles::reserve(size_t capacity)
+{
+    if( capacity <= mCapacity ){
+        return;
+    }
+    grow( mX, mCount, capacity );
+    grow( mY, mCount, capacity );
+    grow( mVelocityX, mCount, capacity );
+    grow( mVelocityY, mCount, capacity );
+    grow( mGravity, mCount, capacity );
+    grow( mVariation, mCount, capacity );
+    grow( mStillFrames, mCount, capacity );
+    // only ever read after collide() fills them
+    grow( mSortedX, 0, capacity );
+    grow( mSortedY, 0, capacity );
+    grow( mSortedVelocityX, 0, capacity );
+    grow( mSortedVelocityY, 0, capacity );
+    grow( mResolvedX, 0, capacity );
+    grow( mResolvedY, 0, capacity );
+    grow( mResolvedVelocityX, 0, capacity );
+    grow( mResolvedVelocityY, 0, capacity );
+    mCapacity = capacity;
+}
+
+void Circles::add(Vec2f position, float variation)
+{
+    if( mCount == mCapacity ){
+        reserve( max( (size_t)1024, mCapacity * 2 ) );
+    }
+    mX[mCount] = position.x;
+    mY[mCount] = position.y;
+    mVelocityX[mCount] = 5.0f * variation;
+    mVelocityY[mCount] = -5.0f * variation;
+    mGravity[mCount] = 0.15f * variation;
+    mVariation[mCount] = variation;
+    mStillFrames[mCount] = 0.0f;
+    mCount++;
+}
+
+void Circles::update(Vec2i windowSize)
+{
+    TRACE_ZONE("Circles::update");
+    updateRange( 0, mCount, windowSize.x, windowSize.y );
+}
+
+void Circles::update(Vec2i windowSize, WorkerPool &pool)
+{
+    TRACE_ZONE("Circles::update");
+    size_t chunkCount = ( mCount + CHUNK_SIZE - 1 ) / CHUNK_SIZE;
+    if( chunkCount <= 1 || pool.getThreadCount() == 1 ){
+        updateRange( 0, mCount, windowSize.x, windowSize.y );
+        return;
+    }
+    pool.run( chunkCount, boost::bind( &Circles::updateChunk, this, _1, (float)windowSize.x, (float)windowSize.y ) );
+}
+
+void Circles::updateChunk(size_t chunk, float width, float height)
+{
+    TRACE_ZONE("chunk");
+    updateRange( chunk * CHUNK_SIZE, min( ( chunk + 1 ) * CHUNK_SIZE, mCount ), width, height );
+}
+
+void Circles::collide(Vec2i windowSize)
+{
+    TRACE_ZONE("Circles::collide");
+    mGrid.build( mX, mY, mCount, windowSize.x, windowSize.y, mRadius * 2.0f );
+    mWakeRequests.resize( mCount );
+    gatherRange( 0, mCount );
+    collideRange( 0, mCount );
+    reorderRange( 0, mCount );
+    swapResolved();
+}
+
+void Circles::collide(Vec2i windowSize, WorkerPool &pool)
+{
+    TRACE_ZONE("Circles::collide");
+    mGrid.build( mX, mY, mCount, windowSize.x, windowSize.y, mRadius * 2.0f, pool );
+    mWakeRequests.resize( mCount );
+    size_t chunkCount = ( mCount + CHUNK_SIZE - 1 ) / CHUNK_SIZE;
+    if( chunkCount <= 1 || pool.getThreadCount() == 1 ){
+        gatherRange( 0, mCount );
+        collideRange( 0, mCount );
+        reorderRange( 0, mCount );
+    } else {
+        // every chunk reads its neighbours' sorted slots, so all of them are
+        // gathered first, and only reused for the rest once all are resolved
+        pool.run( chunkCount, boost::bind( &Circles::gatherChunk, this, _1 ) );
+        pool.run( chunkCount, boost::bind( &Circles::collideChunk, this, _1 ) );
+        pool.run( chunkCount, boost::bind( &Circles::reorderChunk, this, _1 ) );
+    }
+    swapResolved();
+}
+
+void Circles::gatherChunk(size_t chunk)
+{
+    gatherRange( chunk * CHUNK_SIZE, min( ( chunk + 1 ) * CHUNK_SIZE, mCount ) );
+}
+
+void Circles::gatherRange(size_t begin, size_t end)
+{
+    for( size_t k = begin; k < end; k++ ){
+        uint32_t i = mGrid.mIndices[k];
+        mSortedX[k] = mX[i];
+        mSortedY[k] = mY[i];
+        mSortedVelocityX[k] = mVelocityX[i];
+        mSortedVelocityY[k] = mVelocityY[i];
+    }
+}
+
+void Circles::reorderChunk(size_t chunk)
+{
+    reorderRange( chunk * CHUNK_SIZE, min( ( chunk + 1 ) * CHUNK_SIZE, mCount ) );
+}
+
+void Circles::reorderRange(size_t begin, size_t end)
+{
+    for( size_t k = begin; k < end; k++ ){
+        uint32_t i = mGrid.mIndices[k];
+        mSortedX[k] = mGravity[i];
+        mSortedY[k] = mVariation[i];
+        mSortedVelocityX[k] = mStillFrames[i];
+    }
+}
+
+void Circles::collideChunk(size_t chunk)
+{
+    TRACE_ZONE("collide chunk");
+    collideRange( chunk * CHUNK_SIZE, min( ( chunk + 1 ) * CHUNK_SIZE, mCount ) );
+}
+
+void Circles::collideRange(size_t begin, size_t end)
+{
+    const float diameter = mRadius * 2.0f;
+    for( size_t slot = begin; slot < end; slot++ ){
+        float x = mSortedX[slot], y = mSortedY[slot], vx = mSortedVelocityX[slot], vy = mSortedVelocityY[slot];
+        float pushX = 0.0f, pushY = 0.0f, impulseX = 0.0f, impulseY = 0.0f;
+        int contacts = 0;
+
+        uint32_t runBegin[3], runEnd[3];
+        int runs = mGrid.getNeighbors( x, y, runBegin, runEnd );
+        for( int run = 0; run < runs; run++ ){
+            for( uint32_t k = runBegin[run]; k < runEnd[run]; k++ ){
+                float dx = x - mSortedX[k];
+                float dy = y - mSortedY[k];
+                float distanceSquared = dx * dx + dy * dy;
+                // circles on the same spot (and the circle itself) have no direction to separate in;
+                // new circles all start on one spot and drift apart by their variation
+                if( distanceSquared >= diameter * diameter || distanceSquared == 0.0f ){
+                    continue;
+                }
+
+                contacts++;
+                float distance = sqrt( distanceSquared );
+                float nx = dx / distance;
+                float ny = dy / distance;
+                // each circle of the pair moves half the overlap
+                float overlap = ( diameter - distance ) * 0.5f;
+                pushX += nx * overlap;
+                pushY += ny * overlap;
+                // equal masses: each takes its half of the impulse along the normal, if closing
+                float closing = ( vx - mSortedVelocityX[k] ) * nx + ( vy - mSortedVelocityY[k] ) * ny;
+                if( closing < 0.0f ){
+                    float impulse = -( 1.0f + RESTITUTION ) * 0.5f * closing;
+                    impulseX += nx * impulse;
+                    impulseY += ny * impulse;
+                }
+            }
+        }
+
+        // sleepers don't move, so this circle takes the whole overlap and the whole impulse
+        uint32_t woken = NO_WAKE;
+        if( ! mSleepingX.empty() ){
+            runs = mSleepingGrid.getNeighbors( x, y, runBegin, runEnd );
+            for( int run = 0; run < runs; run++ ){
+                for( uint32_t k = runBegin[run]; k < runEnd[run]; k++ ){
+                    uint32_t j = mSleepingGrid.mIndices[k];
+                    float dx = x - mSleepingX[j];
+                    float dy = y - mSleepingY[j];
+                    float distanceSquared = dx * dx + dy * dy;
+                    if( distanceSquared >= diameter * diameter || distanceSquared == 0.0f ){
+                        continue;
+                    }
+
+                    contacts++;
+                    float distance = sqrt( distanceSquared );
+                    float nx = dx / distance;
+                    float ny = dy / distance;
+                    pushX += nx * ( diameter - distance );
+                    pushY += ny * ( diameter - distance );
+                    float closing = vx * nx + vy * ny;
+                    if( closing < 0.0f ){
+                        float impulse = -( 1.0f + RESTITUTION ) * closing;
+                        impulseX += nx * impulse;
+                        impulseY += ny * impulse;
+                        if( -closing > WAKE_SPEED ){
+                            woken = j;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Every impulse above is worked out as if it were the circle's only
+        // contact, from velocities before the call, so a circle packed in among
+        // several would take all of them at once and leave faster than it came
+        // in; piles would gain energy instead of settling. Sharing them out
+        // over the contacts stops that, and the damping bleeds off the rest.
+        float damping = 1.0f;
+        if( contacts > 0 ){
+            impulseX /= contacts;
+            impulseY /= contacts;
+            damping = CONTACT_DAMPING;
+        }
+
+        // written in grid order, which becomes the circles' order; one slot per
+        // circle, so threads never share a write; sleep() collects the wake requests
+        mWakeRequests[slot] = woken;
+        mResolvedX[slot] = x + pushX;
+        mResolvedY[slot] = y + pushY;
+        mResolvedVelocityX[slot] = ( vx + impulseX ) * damping;
+        mResolvedVelocityY[slot] = ( vy + impulseY ) * damping;
+    }
+}
+
+void Circles::swapResolved()
+{
+    swap( mX, mResolvedX );
+    swap( mY, mResolvedY );
+    swap( mVelocityX, mResolvedVelocityX );
+    swap( mVelocityY, mResolvedVelocityY );
+    swap( mGravity, mSortedX );
+    swap( mVariation, mSortedY );
+    swap( mStillFrames, mSortedVelocityX );
+}
+
+void Circles::sleep(Vec2i windowSize)
+{
+    TRACE_ZONE("Circles::sleep");
+    size_t sleepingBefore = mSleepingX.size();
+    // a sleeper hit by several circles wakes once; requests left from before
+    // the last sleep() or wakeAll() point at the wrong sleepers
+    vector<bool> woken( sleepingBefore, false );
+    bool waking = false;
+    if( mWakeRequests.size() == mCount ){
+        for( size_t i = 0; i < mCount; i++ ){
+            if( mWakeRequests[i] != NO_WAKE ){
+                woken[mWakeRequests[i]] = true;
+                waking = true;
+            }
+        }
+    }
+    mWakeRequests.clear();
+
+    // Sleepers that left last time may have been holding others up. The ones
+    // that lost their support wake and fall, which is checked for again next
+    // time, so a pile whose bottom goes comes down a layer per frame.
+    if( mSupportLost ){
+        for( size_t j = 0; j < sleepingBefore; j++ ){
+            if( ! woken[j] && ! isSupported( mSleepingX[j], mSleepingY[j], windowSize.y ) ){
+                woken[j] = true;
+                waking = true;
+            }
+        }
+    }
+
+    // The last circle fills each sleeper's slot and is looked at next, so this
+    // costs a move per sleeper instead of one per circle; neither update nor
+    // collide cares about the order. A still circle with nothing fixed under it
+    // keeps counting until what it rests on falls asleep first.
+    if( countStill( 0, mCount ) >= SLEEP_FRAMES ){
+        size_t i = 0;
+        while( i < mCount ){
+            if( mStillFrames[i] < SLEEP_FRAMES || ! isSupported( mX[i], mY[i], windowSize.y ) ){
+                i++;
+                continue;
+            }
+            mSleepingX.push_back( mX[i] );
+            mSleepingY.push_back( mY[i] );
+            mSleepingVariation.push_back( mVariation[i] );
+            mCount--;
+            move( mCount, i );
+        }
+    }
+
+    // woken sleepers rejoin at rest; the ones that just fell asleep stay put behind the rest
+    if( waking ){
+        size_t keptSleeping = 0;
+        for( size_t j = 0; j < mSleepingX.size(); j++ ){
+            if( j < sleepingBefore && woken[j] ){
+                add( Vec2f(mSleepingX[j], mSleepingY[j]), mSleepingVariation[j] );
+                mVelocityX[mCount - 1] = 0.0f;
+                mVelocityY[mCount - 1] = 0.0f;
+                continue;
+            }
+            mSleepingX[keptSleeping] = mSleepingX[j];
+            mSleepingY[keptSleeping] = mSleepingY[j];
+            mSleepingVariation[keptSleeping] = mSleepingVariation[j];
+            keptSleeping++;
+        }
+        mSleepingX.resize( keptSleeping );
+        mSleepingY.resize( keptSleeping );
+        mSleepingVariation.resize( keptSleeping );
+        mSleepingRemoved = true;
+    }
+
+    // retiring down to three quarters of the cap rather than to the cap means
+    // SleepLayer redraws its picture once per batch, not every frame
+    bool retiring = mMaxCircles > 0 && getTotal() >= mMaxCircles && ! mSleepingX.empty();
+    if( retiring ){
+        size_t count = min( getTotal() - mMaxCircles * 3 / 4, mSleepingX.size() );
+        mSleepingX.erase( mSleepingX.begin(), mSleepingX.begin() + count );
+        mSleepingY.erase( mSleepingY.begin(), mSleepingY.begin() + count );
+        mSleepingVariation.erase( mSleepingVariation.begin(), mSleepingVariation.begin() + count );
+        mSleepingRemoved = true;
+    }
+
+    mSupportLost = waking || retiring;
+    if( waking || retiring || mSleepingX.size() != sleepingBefore ){
+        mSleepingGrid.build( mSleepingX.empty() ? 0 : &mSleepingX[0], mSleepingY.empty() ? 0 : &mSleepingY[0],
+                             mSleepingX.size(), windowSize.x, windowSize.y, mRadius * 2.0f );
+    }
+}
+
+void Circles::wakeAll()
+{
+    if( mSleepingX.empty() ){
+        return;
+    }
+    for( size_t j = 0; j < mSleepingX.size(); j++ ){
+        add( Vec2f(mSleepingX[j], mSleepingY[j]), mSleepingVariation[j] );
+        mVelocityX[mCount - 1] = 0.0f;
+        mVelocityY[mCount - 1] = 0.0f;
+    }
+    mSleepingX.clear();
+    mSleepingY.clear();
+    mSleepingVariation.clear();
+    mSleepingGrid.build( 0, 0, 0, 1.0f, 1.0f, mRadius * 2.0f );
+    mWakeRequests.clear();
+    mSleepingRemoved = true;
+    mSupportLost = false;
+}
+
+bool Circles::isSupported(float x, float y, float height) const
+{
+    if( y >= height - mRadius - SUPPORT_GAP ){
+        return true;
+    }
+    if( mSleepingX.empty() ){
+        return false;
+    }
+    // centred half a circle down, the query reaches every sleeper up to a
+    // diameter and the gap below
+    const float reach = mRadius * 2.0f + SUPPORT_GAP;
+    uint32_t runBegin[3], runEnd[3];
+    int runs = mSleepingGrid.getNeighbors( x, y + mRadius, runBegin, runEnd );
+    for( int run = 0; run < runs; run++ ){
+        for( uint32_t k = runBegin[run]; k < runEnd[run]; k++ ){
+            uint32_t j = mSleepingGrid.mIndices[k];
+            float dx = mSleepingX[j] - x;
+            float dy = mSleepingY[j] - y;
+            if( dy > 0.0f && dx * dx + dy * dy < reach * reach ){
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+float Circles::countStill(size_t begin, size_t end)
+{
+#if defined( CIRCLES_SSE2 )
+    size_t i = min( ( begin + 3 ) & ~(size_t)3, end );
+    float most = countStillScalar( begin, i );
+
+    const __m128 limit = _mm_set1_ps( SLEEP_SPEED * SLEEP_SPEED );
+    const __m128 one = _mm_set1_ps( 1.0f );
+    __m128 highest = _mm_setzero_ps();
+    for( ; i + 4 <= end; i += 4 ){
+        __m128 vx = _mm_load_ps( mVelocityX + i );
+        __m128 vy = _mm_load_ps( mVelocityY + i );
+        __m128 speedSquared = _mm_add_ps( _mm_mul_ps( vx, vx ), _mm_mul_ps( vy, vy ) );
+        // one more frame where slow, back to zero where not
+        __m128 still = _mm_and_ps( _mm_add_ps( _mm_load_ps( mStillFrames + i ), one ), _mm_cmplt_ps( speedSquared, limit ) );
+        _mm_store_ps( mStillFrames + i, still );
+        highest = _mm_max_ps( highest, still );
+    }
+    float lanes[4];
+    _mm_storeu_ps( lanes, highest );
+    most = max( most, max( max( lanes[0], lanes[1] ), max( lanes[2], lanes[3] ) ) );
+    return max( most, countStillScalar( i, end ) );
+#else
+    return countStillScalar( begin, end );
+#endif
+}
+
+float Circles::countStillScalar(size_t begin, size_t end)
+{
+    float most = 0.0f;
+    for( size_t i = begin; i < end; i++ ){
+        float speedSquared = mVelocityX[i] * mVelocityX[i] + mVelocityY[i] * mVelocityY[i];
+        mStillFrames[i] = speedSquared < SLEEP_SPEED * SLEEP_SPEED ? mStillFrames[i] + 1.0f : 0.0f;
+        most = max( most, mStillFrames[i] );
+    }
+    return most;
+}
+
+void Circles::move(size_t from, size_t to)
+{
+    if( from == to ){
+        return;
+    }
+    mX[to] = mX[from];
+    mY[to] = mY[from];
+    mVelocityX[to] = mVelocityX[from];
+    mVelocityY[to] = mVelocityY[from];
+    mGravity[to] = mGravity[from];
+    mVariation[to] = mVariation[from];
+    mStillFrames[to] = mStillFrames[from];
+}
+
+void Circles::updateRange(size_t begin, size_t end, float width, float height)
+{
+#if defined( CIRCLES_SSE2 )
+    // the arrays start 16 byte aligned, so groups of four start at multiples of four
+    size_t i = min( ( begin + 3 ) & ~(size_t)3, end );
+    updateScalar( begin, i, width, height );
+
+    const __m128 left = _mm_set1_ps( mRadius );
+    const __m128 top = left;
+    const __m128 rightEdge = _mm_set1_ps( width - mRadius );
+    const __m128 bottomEdge = _mm_set1_ps( height - mRadius );
+    const __m128 one = _mm_set1_ps( 1.0f );
+    const __m128 bounce = _mm_set1_ps( 0.8f );
+    const __m128 sign = _mm_set1_ps( -0.0f );
+    for( ; i + 4 <= end; i += 4 ){
+        __m128 x = _mm_load_ps( mX + i );
+        __m128 y = _mm_load_ps( mY + i );
+        __m128 vx = _mm_load_ps( mVelocityX + i );
+        __m128 vy = _mm_load_ps( mVelocityY + i );
+        __m128 damping = _mm_mul_ps( bounce, _mm_load_ps( mVariation + i ) );
+
+        // a circle past an edge flips that velocity component, goes back inside
+        // and loses speed; circles inside are clamped and scaled by one, which
+        // leaves them exactly as they were
+        __m128 out = _mm_or_ps( _mm_cmpgt_ps( x, rightEdge ), _mm_cmplt_ps( x, left ) );
+        vx = _mm_xor_ps( vx, _mm_and_ps( out, sign ) );
+        x = _mm_max_ps( _mm_min_ps( x, rightEdge ), left );
+        __m128 scale = _mm_or_ps( _mm_and_ps( out, damping ), _mm_andnot_ps( out, one ) );
+        vx = _mm_mul_ps( vx, scale );
+        vy = _mm_mul_ps( vy, scale );
+
+        out = _mm_or_ps( _mm_cmpgt_ps( y, bottomEdge ), _mm_cmplt_ps( y, top ) );
+        vy = _mm_xor_ps( vy, _mm_and_ps( out, sign ) );
+        y = _mm_max_ps( _mm_min_ps( y, bottomEdge ), top );
+        scale = _mm_or_ps( _mm_and_ps( out, damping ), _mm_andnot_ps( out, one ) );
+        vx = _mm_mul_ps( vx, scale );
+        vy = _mm_mul_ps( vy, scale );
+
+        vy = _mm_add_ps( vy, _mm_load_ps( mGravity + i ) );
+        _mm_store_ps( mX + i, _mm_add_ps( x, vx ) );
+        _mm_store_ps( mY + i, _mm_add_ps( y, vy ) );
+        _mm_store_ps( mVelocityX + i, vx );
+        _mm_store_ps( mVelocityY + i, vy );
+    }
+    updateScalar( i, end, width, height );
+#else
+    updateScalar( begin, end, width, height );
+#endif
+}
+
+void Circles::updateScalar(size_t begin, size_t end, float width, float height)
+{
+    const float right = width - mRadius;
+    const float bottom = height - mRadius;
+    for( size_t i = begin; i < end; i++ ){
+        float x = mX[i], y = mY[i], vx = mVelocityX[i], vy = mVelocityY[i];
+        float damping = 0.8f * mVariation[i];
+
+        if( x > right || x < mRadius ){
+            vx = -vx;
+            x = max( min( x, right ), mRadius );
+            vx *= damping;
+            vy *= damping;
+        }
+        if( y > bottom || y < mRadius ){
+            vy = -vy;
+            y = max( min( y, bottom ), mRadius );
+            vx *= damping;
+            vy *= damping;
+        }
+
+        vy += mGravity[i];
+        mX[i] = x + vx;
+        mY[i] = y + vy;
+        mVelocityX[i] = vx;
+        mVelocityY[i] = vy;
+    }
+}
+
+void Circles::draw()
+{
+    for( size_t i = 0; i < mCount; i++ ){
+        gl::drawSolidCircle( Vec2f(mX[i], mY[i]), mRadius );
+    }
+}
+
+// count white circles at x, y
+static void drawWhite(CircleRenderer &renderer, const float *x, const float *y, size_t count, float radius)
+{
+    renderer.mInstances.resize( count );
+    for( size_t i = 0; i < count; i++ ){
+        CircleRenderer::Instance &instance = renderer.mInstances[i];
+        instance.mX = x[i];
+        instance.mY = y[i];
+        instance.mRadius = radius;
+        memset( instance.mColor, 255, 4 );
+    }
+    renderer.draw();
+}
+
+void Circles::draw(CircleRenderer &renderer)
+{
+    drawWhite( renderer, mX, mY, mCount, mRadius );
+}
+
+void Circles::drawSleeping(CircleRenderer &renderer, size_t begin)
+{
+    if( begin < mSleepingX.size() ){
+        drawWhite( renderer, &mSleepingX[begin], &mSleepingY[begin], mSleepingX.size() - begin, mRadius );
+    }
+}
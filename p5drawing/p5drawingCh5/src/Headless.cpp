@@ -0,0 +1,96 @@
+#include "Headless.h"
+
+#if defined( HEADLESS )
+#include "cinder/gl/gl.h"
+#include "cinder/Timer.h"
+#include <GL/osmesa.h>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+HeadlessApp::HeadlessApp()
+    : mWidth(640), mHeight(480), mFrame(0), mFrames(300), mWarmup(0), mName("frames")
+{
+}
+
+int HeadlessApp::run(HeadlessApp *app, int argc, char *argv[])
+{
+    for( int i = 1; i < argc; i += 2 ){
+        // every option takes a value, so a trailing one without it, or a stray
+        // argument that shifted the pairs, is as unknown as a misspelt one
+        if( i + 1 == argc ){
+            cerr << "unknown option " << argv[i] << endl;
+            delete app;
+            return 1;
+        }
+        if( strcmp(argv[i], "--frames") == 0 ){
+            app->mFrames = atoi(argv[i + 1]);
+        } else if( strcmp(argv[i], "--warmup") == 0 ){
+            app->mWarmup = atoi(argv[i + 1]);
+        } else if( strcmp(argv[i], "--bench") == 0 ){
+            app->mBenchPath = argv[i + 1];
+        } else if( strcmp(argv[i], "--name") == 0 ){
+            app->mName = argv[i + 1];
+        } else if( strcmp(argv[i], "--size") == 0 ){
+            sscanf(argv[i + 1], "%dx%d", &app->mWidth, &app->mHeight);
+        } else if( strcmp(argv[i], "--dump") == 0 ){
+            app->mDumpDirectory = argv[i + 1];
+        } else if( ! app->setOption(argv[i], argv[i + 1]) ){
+            cerr << "unknown option " << argv[i] << endl;
+            delete app;
+            return 1;
+        }
+    }
+    
+    OSMesaContext context = OSMesaCreateContextExt(OSMESA_RGBA, 24, 0, 0, NULL);
+    app->mPixels.resize(app->mWidth * app->mHeight * 4);
+    if( ! context || ! OSMesaMakeCurrent(context, &app->mPixels[0], GL_UNSIGNED_BYTE, app->mWidth, app->mHeight) ){
+        cerr << "could not create an OSMesa context" << endl;
+        return 1;
+    }
+    OSMesaPixelStore(OSMESA_Y_UP, 0);
+    
+    // what RendererGl sets up for a new window
+    glViewport(0, 0, app->mWidth, app->mHeight);
+    gl::setMatricesWindow(app->mWidth, app->mHeight);
+    
+    app->setup();
+    
+    Timer timer;
+    uint32_t total = app->mWarmup + app->mFrames;
+    for( app->mFrame = 0; app->mFrame < total; app->mFrame++ ){
+        timer.start();
+        app->update();
+        timer.stop();
+        double updateSeconds = timer.getSeconds();
+        
+        timer.start();
+        app->draw();
+        glFinish();
+        timer.stop();
+        
+        if( app->mFrame >= app->mWarmup ){
+            app->mStats.add(updateSeconds, timer.getSeconds());
+        }
+        if( ! app->mDumpDirectory.empty() ){
+            app->dumpFrame();
+        }
+    }
+    app->shutdown();
+    
+    if( ! app->mBenchPath.empty() && ! app->mStats.write(app->mBenchPath, app->mName) ){
+        cerr << "could not write " << app->mBenchPath << endl;
+    }
+    delete app;
+    OSMesaDestroyContext(context);
+    return 0;
+}
+
+void HeadlessApp::dumpFrame()
+{
+    char name[32];
+    sprintf(name, "/frame_%05u.png", mFrame);
+    writeImage(mDumpDirectory + name, Surface8u(&mPixels[0], mWidth, mHeight, mWidth * 4, SurfaceChannelOrder::RGBA));
+}
+
+#endif
@@ -0,0 +1,197 @@
+#include "Philox.h"
+#include <algorithm>
+
+#if defined( __SSE2__ ) || defined( _M_IX86 ) || defined( _M_X64 )
+    #define PHILOX_SSE2
+    #include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// multipliers and key increments from the paper
+static const uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+static const uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+static const int ROUNDS = 10;
+// values converted per pass in fillFloat and fillInt
+static const size_t BATCH = 64;
+
+static void block(uint32_t seed, uint32_t stream, uint64_t counter, uint32_t out[4])
+{
+    uint32_t c0 = (uint32_t)counter, c1 = (uint32_t)( counter >> 32 ), c2 = 0, c3 = 0;
+    uint32_t k0 = seed, k1 = stream;
+    for( int round = 0; round < ROUNDS; round++ ){
+        uint64_t p0 = (uint64_t)M0 * c0;
+        uint64_t p1 = (uint64_t)M1 * c2;
+        c0 = (uint32_t)( p1 >> 32 ) ^ c1 ^ k0;
+        c1 = (uint32_t)p1;
+        c2 = (uint32_t)( p0 >> 32 ) ^ c3 ^ k1;
+        c3 = (uint32_t)p0;
+        k0 += W0;
+        k1 += W1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+#if defined( PHILOX_SSE2 )
+// 32x32 -> 64 bit products of all four lanes; SSE2 only multiplies lanes 0 and 2,
+// so the odd lanes go through a second multiply shifted down
+static void mulHiLo(__m128i a, __m128i m, __m128i &hi, __m128i &lo)
+{
+    __m128i even = _mm_mul_epu32( a, m );
+    __m128i odd = _mm_mul_epu32( _mm_srli_epi64( a, 32 ), _mm_srli_epi64( m, 32 ) );
+    lo = _mm_unpacklo_epi32( _mm_shuffle_epi32( even, _MM_SHUFFLE( 0, 0, 2, 0 ) ), _mm_shuffle_epi32( odd, _MM_SHUFFLE( 0, 0, 2, 0 ) ) );
+    hi = _mm_unpacklo_epi32( _mm_shuffle_epi32( even, _MM_SHUFFLE( 0, 0, 3, 1 ) ), _mm_shuffle_epi32( odd, _MM_SHUFFLE( 0, 0, 3, 1 ) ) );
+}
+
+// Blocks counter to counter + 3, one per lane, written out as 16 consecutive values
+static void blocks4(uint32_t seed, uint32_t stream, uint64_t counter, uint32_t *out)
+{
+    uint64_t n0 = counter, n1 = counter + 1, n2 = counter + 2, n3 = counter + 3;
+    __m128i c0 = _mm_set_epi32( (int)n3, (int)n2, (int)n1, (int)n0 );
+    __m128i c1 = _mm_set_epi32( (int)( n3 >> 32 ), (int)( n2 >> 32 ), (int)( n1 >> 32 ), (int)( n0 >> 32 ) );
+    __m128i c2 = _mm_setzero_si128();
+    __m128i c3 = _mm_setzero_si128();
+    const __m128i m0 = _mm_set1_epi32( (int)M0 );
+    const __m128i m1 = _mm_set1_epi32( (int)M1 );
+    uint32_t k0 = seed, k1 = stream;
+    for( int round = 0; round < ROUNDS; round++ ){
+        __m128i hi0, lo0, hi1, lo1;
+        mulHiLo( c0, m0, hi0, lo0 );
+        mulHiLo( c2, m1, hi1, lo1 );
+        c0 = _mm_xor_si128( _mm_xor_si128( hi1, c1 ), _mm_set1_epi32( (int)k0 ) );
+        c1 = lo1;
+        c2 = _mm_xor_si128( _mm_xor_si128( hi0, c3 ), _mm_set1_epi32( (int)k1 ) );
+        c3 = lo0;
+        k0 += W0;
+        k1 += W1;
+    }
+
+    // lanes hold one word of every block; transpose so each block's words are adjacent
+    __m128i t0 = _mm_unpacklo_epi32( c0, c1 );
+    __m128i t1 = _mm_unpacklo_epi32( c2, c3 );
+    __m128i t2 = _mm_unpackhi_epi32( c0, c1 );
+    __m128i t3 = _mm_unpackhi_epi32( c2, c3 );
+    _mm_storeu_si128( (__m128i*)out, _mm_unpacklo_epi64( t0, t1 ) );
+    _mm_storeu_si128( (__m128i*)( out + 4 ), _mm_unpackhi_epi64( t0, t1 ) );
+    _mm_storeu_si128( (__m128i*)( out + 8 ), _mm_unpacklo_epi64( t2, t3 ) );
+    _mm_storeu_si128( (__m128i*)( out + 12 ), _mm_unpackhi_epi64( t2, t3 ) );
+}
+#endif
+
+// top 24 bits, so every result is exactly representable before scaling
+static float toFloat(uint32_t bits, float min, float range)
+{
+    return min + (float)( bits >> 8 ) * ( 1.0f / 16777216.0f ) * range;
+}
+
+// multiply-shift into [0, range), which avoids a division
+static int32_t toInt(uint32_t bits, int32_t min, uint32_t range)
+{
+    return min + (int32_t)( ( (uint64_t)bits * range ) >> 32 );
+}
+
+Philox::Philox(uint32_t seed, uint32_t stream)
+    : mSeed(seed), mStream(stream), mNext(0)
+{
+}
+
+void Philox::fillUint(uint32_t *out, size_t count)
+{
+    uint64_t index = mNext;
+    mNext += count;
+
+    size_t i = 0;
+    uint32_t words[4];
+    // finish the block index starts in
+    if( index % 4 != 0 ){
+        block( mSeed, mStream, index / 4, words );
+        for( ; i < count && ( index + i ) % 4 != 0; i++ ){
+            out[i] = words[( index + i ) % 4];
+        }
+    }
+
+    uint64_t counter = ( index + i ) / 4;
+#if defined( PHILOX_SSE2 )
+    for( ; i + 16 <= count; i += 16, counter += 4 ){
+        blocks4( mSeed, mStream, counter, out + i );
+    }
+#endif
+    for( ; i < count; i += 4, counter++ ){
+        block( mSeed, mStream, counter, words );
+        for( size_t w = 0; w < 4 && i + w < count; w++ ){
+            out[i + w] = words[w];
+        }
+    }
+}
+
+void Philox::fillFloat(float *out, size_t count, float min, float max)
+{
+    uint32_t bits[BATCH];
+    float range = max - min;
+    for( size_t done = 0; done < count; done += BATCH ){
+        size_t n = std::min( BATCH, count - done );
+        fillUint( bits, n );
+
+        size_t i = 0;
+#if defined( PHILOX_SSE2 )
+        const __m128 scale = _mm_set1_ps( 1.0f / 16777216.0f );
+        const __m128 offset = _mm_set1_ps( min );
+        const __m128 width = _mm_set1_ps( range );
+        for( ; i + 4 <= n; i += 4 ){
+            __m128 f = _mm_cvtepi32_ps( _mm_srli_epi32( _mm_loadu_si128( (const __m128i*)( bits + i ) ), 8 ) );
+            _mm_storeu_ps( out + done + i, _mm_add_ps( offset, _mm_mul_ps( _mm_mul_ps( f, scale ), width ) ) );
+        }
+#endif
+        for( ; i < n; i++ ){
+            out[done + i] = toFloat( bits[i], min, range );
+        }
+    }
+}
+
+void Philox::fillInt(int32_t *out, size_t count, int32_t min, int32_t max)
+{
+    uint32_t bits[BATCH];
+    uint32_t range = (uint32_t)( max - min );
+    for( size_t done = 0; done < count; done += BATCH ){
+        size_t n = std::min( BATCH, count - done );
+        fillUint( bits, n );
+
+        size_t i = 0;
+#if defined( PHILOX_SSE2 )
+        const __m128i width = _mm_set1_epi32( (int)range );
+        const __m128i offset = _mm_set1_epi32( min );
+        for( ; i + 4 <= n; i += 4 ){
+            __m128i hi, lo;
+            mulHiLo( _mm_loadu_si128( (const __m128i*)( bits + i ) ), width, hi, lo );
+            _mm_storeu_si128( (__m128i*)( out + done + i ), _mm_add_epi32( offset, hi ) );
+        }
+#endif
+        for( ; i < n; i++ ){
+            out[done + i] = toInt( bits[i], min, range );
+        }
+    }
+}
+
+float Philox::nextFloat(float min, float max)
+{
+    float value;
+    fillFloat( &value, 1, min, max );
+    return value;
+}
+
+int32_t Philox::nextInt(int32_t min, int32_t max)
+{
+    int32_t value;
+    fillInt( &value, 1, min, max );
+    return value;
+}
+
+uint32_t Philox::get(uint32_t seed, uint32_t stream, uint64_t index)
+{
+    uint32_t words[4];
+    block( seed, stream, index / 4, words );
+    return words[index % 4];
+}
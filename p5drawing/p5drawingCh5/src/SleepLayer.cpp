@@ -0,0 +1,72 @@
+#include "SleepLayer.h"
+#include "Trace.h"
+
+SleepLayer::SleepLayer()
+    : mDrawn(0)
+{
+}
+
+void SleepLayer::draw(Circles &circles, CircleRenderer &renderer, Vec2i windowSize)
+{
+    TRACE_ZONE("SleepLayer::draw");
+    // a new window size wakes every sleeper, so the new picture starts empty
+    if( ! mLayer || mLayer.getSize() != windowSize ){
+        mLayer = gl::Fbo( windowSize.x, windowSize.y );
+        circles.mSleepingRemoved = true;
+    }
+
+    if( circles.mSleepingRemoved ){
+        bind( mLayer );
+        gl::clear();
+        circles.drawSleeping( renderer, 0 );
+        unbind( mLayer, windowSize );
+        circles.mSleepingRemoved = false;
+    } else if( mDrawn < circles.mSleepingX.size() ){
+        bind( mLayer );
+        circles.drawSleeping( renderer, mDrawn );
+        unbind( mLayer, windowSize );
+    }
+    mDrawn = circles.mSleepingX.size();
+
+    drawTexture( windowSize );
+}
+
+void SleepLayer::bind(gl::Fbo &fbo)
+{
+    fbo.bindFramebuffer();
+    gl::pushMatrices();
+    gl::setViewport( fbo.getBounds() );
+    // the same matrices as the window, so sleepers go where they would on screen
+    gl::setMatricesWindow( fbo.getSize() );
+}
+
+void SleepLayer::unbind(gl::Fbo &fbo, Vec2i windowSize)
+{
+    fbo.unbindFramebuffer();
+    gl::popMatrices();
+    gl::setViewport( Area( 0, 0, windowSize.x, windowSize.y ) );
+}
+
+void SleepLayer::drawTexture(Vec2i windowSize)
+{
+    // Drawn with a top left origin, the picture's top row is the texture's
+    // last one, so the quad maps the window's top to t = 1 itself rather than
+    // going through the texture's flipped flag. The picture is opaque, black
+    // where there are no sleepers, and replaces whatever is under it.
+    gl::Texture &texture = mLayer.getTexture();
+    gl::disableAlphaBlending();
+    gl::color( Color( 1.0f, 1.0f, 1.0f ) );
+    texture.enableAndBind();
+    glBegin( GL_QUADS );
+    glTexCoord2f( 0.0f, 1.0f );
+    glVertex2f( 0.0f, 0.0f );
+    glTexCoord2f( 1.0f, 1.0f );
+    glVertex2f( windowSize.x, 0.0f );
+    glTexCoord2f( 1.0f, 0.0f );
+    glVertex2f( windowSize.x, windowSize.y );
+    glTexCoord2f( 0.0f, 0.0f );
+    glVertex2f( 0.0f, windowSize.y );
+    glEnd();
+    texture.unbind();
+    texture.disable();
+}
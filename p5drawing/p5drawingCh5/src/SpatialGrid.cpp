@@ -0,0 +1,147 @@
+#include "SpatialGrid.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <boost/bind.hpp>
+
+SpatialGrid::SpatialGrid()
+    : mCellSize(1.0f), mColumns(0), mRows(0), mCount(0), mChunks(0), mBands(0)
+{
+}
+
+void SpatialGrid::build(const float *x, const float *y, size_t count, float width, float height, float cellSize)
+{
+    TRACE_ZONE("SpatialGrid::build");
+    prepare( count, width, height, cellSize );
+    for( size_t chunk = 0; chunk < mChunks; chunk++ ){
+        countChunk( chunk, x, y );
+    }
+    sumBands();
+    for( size_t chunk = 0; chunk < mChunks; chunk++ ){
+        scatterChunk( chunk );
+    }
+    for( size_t band = 0; band < mBands; band++ ){
+        sortBand( band );
+    }
+}
+
+void SpatialGrid::build(const float *x, const float *y, size_t count, float width, float height, float cellSize, WorkerPool &pool)
+{
+    if( count <= CHUNK_SIZE || pool.getThreadCount() == 1 ){
+        build( x, y, count, width, height, cellSize );
+        return;
+    }
+    TRACE_ZONE("SpatialGrid::build");
+    prepare( count, width, height, cellSize );
+    pool.run( mChunks, boost::bind( &SpatialGrid::countChunk, this, _1, x, y ) );
+    sumBands();
+    pool.run( mChunks, boost::bind( &SpatialGrid::scatterChunk, this, _1 ) );
+    pool.run( mBands, boost::bind( &SpatialGrid::sortBand, this, _1 ) );
+}
+
+void SpatialGrid::prepare(size_t count, float width, float height, float cellSize)
+{
+    mCellSize = cellSize;
+    mColumns = max( 1, (int)ceil( width / cellSize ) );
+    mRows = max( 1, (int)ceil( height / cellSize ) );
+    mCount = count;
+    mChunks = ( count + CHUNK_SIZE - 1 ) / CHUNK_SIZE;
+    mBands = ( mRows + BAND_ROWS - 1 ) / BAND_ROWS;
+    // every band writes its own cells' entries, so only the first is set here
+    mStarts.resize( mColumns * mRows + 1 );
+    mStarts[0] = 0;
+    mNext.resize( mColumns * mRows );
+    mCells.resize( count );
+    mBanded.resize( count );
+    mIndices.resize( count );
+    mChunkBands.assign( mChunks * mBands, 0 );
+    mBandStarts.resize( mBands + 1 );
+}
+
+void SpatialGrid::countChunk(size_t chunk, const float *x, const float *y)
+{
+    uint32_t *counts = &mChunkBands[chunk * mBands];
+    size_t end = min( ( chunk + 1 ) * CHUNK_SIZE, mCount );
+    for( size_t i = chunk * CHUNK_SIZE; i < end; i++ ){
+        int row = getRow( y[i] );
+        mCells[i] = row * mColumns + getColumn( x[i] );
+        counts[row / BAND_ROWS]++;
+    }
+}
+
+void SpatialGrid::sumBands()
+{
+    // band by band, and within a band chunk by chunk, so the points of a band keep their order
+    uint32_t start = 0;
+    for( size_t band = 0; band < mBands; band++ ){
+        mBandStarts[band] = start;
+        for( size_t chunk = 0; chunk < mChunks; chunk++ ){
+            uint32_t count = mChunkBands[chunk * mBands + band];
+            mChunkBands[chunk * mBands + band] = start;
+            start += count;
+        }
+    }
+    mBandStarts[mBands] = start;
+}
+
+void SpatialGrid::scatterChunk(size_t chunk)
+{
+    uint32_t *next = &mChunkBands[chunk * mBands];
+    const uint32_t bandCells = BAND_ROWS * mColumns;
+    size_t end = min( ( chunk + 1 ) * CHUNK_SIZE, mCount );
+    for( size_t i = chunk * CHUNK_SIZE; i < end; i++ ){
+        mBanded[next[mCells[i] / bandCells]++] = (uint32_t)i;
+    }
+}
+
+void SpatialGrid::sortBand(size_t band)
+{
+    uint32_t first = band * BAND_ROWS * mColumns;
+    uint32_t last = min( (int)( band + 1 ) * BAND_ROWS, mRows ) * mColumns;
+    uint32_t begin = mBandStarts[band];
+    uint32_t end = mBandStarts[band + 1];
+    
+    // counted one slot up, so the running sum leaves every cell's start in
+    // place; the band's first start is the previous band's end, already known
+    fill( mStarts.begin() + first + 1, mStarts.begin() + last + 1, 0 );
+    for( uint32_t k = begin; k < end; k++ ){
+        mStarts[mCells[mBanded[k]] + 1]++;
+    }
+    uint32_t start = begin;
+    for( uint32_t cell = first; cell < last; cell++ ){
+        mNext[cell] = start;
+        start += mStarts[cell + 1];
+        mStarts[cell + 1] = start;
+    }
+    
+    for( uint32_t k = begin; k < end; k++ ){
+        uint32_t i = mBanded[k];
+        mIndices[mNext[mCells[i]]++] = i;
+    }
+}
+
+int SpatialGrid::getColumn(float x) const
+{
+    return min( max( (int)floor( x / mCellSize ), 0 ), mColumns - 1 );
+}
+
+int SpatialGrid::getRow(float y) const
+{
+    return min( max( (int)floor( y / mCellSize ), 0 ), mRows - 1 );
+}
+
+int SpatialGrid::getNeighbors(float x, float y, uint32_t begin[3], uint32_t end[3]) const
+{
+    int column = getColumn( x );
+    int row = getRow( y );
+    int first = max( column - 1, 0 );
+    int last = min( column + 1, mColumns - 1 );
+
+    int runs = 0;
+    for( int r = max( row - 1, 0 ); r <= min( row + 1, mRows - 1 ); r++ ){
+        begin[runs] = mStarts[r * mColumns + first];
+        end[runs] = mStarts[r * mColumns + last + 1];
+        runs++;
+    }
+    return runs;
+}
@@ -0,0 +1,112 @@
+#include "Trace.h"
+
+#if defined( TRACE )
+#include "cinder/Timer.h"
+#include <boost/thread.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+using namespace ci;
+
+struct TraceEvent {
+    const char *mName;
+    double mStart, mEnd;
+};
+
+// Written by one thread at a time; the mutex only keeps write() from reading half an event
+struct TraceRing {
+    TraceRing(int lane) : mEvents(TRACE_RING_SIZE), mCount(0), mLane(lane) {}
+    
+    vector<TraceEvent> mEvents;
+    size_t mCount;
+    int mLane;
+    boost::mutex mMutex;
+};
+
+static Timer sClock(true);
+static boost::mutex sRingsMutex;
+static vector<TraceRing*> sRings, sFreeRings;
+
+static void releaseRing(TraceRing *ring)
+{
+    boost::lock_guard<boost::mutex> lock(sRingsMutex);
+    sFreeRings.push_back(ring);
+}
+
+static boost::thread_specific_ptr<TraceRing> sThreadRing(releaseRing);
+
+static TraceRing* getThreadRing()
+{
+    TraceRing *ring = sThreadRing.get();
+    if( ! ring ) {
+        boost::lock_guard<boost::mutex> lock(sRingsMutex);
+        if( sFreeRings.empty() ) {
+            ring = new TraceRing(sRings.size());
+            sRings.push_back(ring);
+        } else {
+            ring = sFreeRings.back();
+            sFreeRings.pop_back();
+        }
+        sThreadRing.reset(ring);
+    }
+    return ring;
+}
+
+double Trace::now()
+{
+    return sClock.getSeconds();
+}
+
+void Trace::record(const char *name, double start, double end)
+{
+    TraceRing *ring = getThreadRing();
+    boost::lock_guard<boost::mutex> lock(ring->mMutex);
+    TraceEvent &event = ring->mEvents[ring->mCount % TRACE_RING_SIZE];
+    event.mName = name;
+    event.mStart = start;
+    event.mEnd = end;
+    ring->mCount++;
+}
+
+// writes the trace once main() returns
+struct TraceWriter {
+    ~TraceWriter() { Trace::write(); }
+};
+static TraceWriter sWriter;
+
+void Trace::write()
+{
+    const char *path = getenv("TRACE_FILE") ? getenv("TRACE_FILE") : "trace.json";
+    ofstream file(path);
+    file << "{\"traceEvents\": [";
+    
+    bool first = true;
+    boost::lock_guard<boost::mutex> ringsLock(sRingsMutex);
+    for( size_t r = 0; r < sRings.size(); r++ ) {
+        TraceRing *ring = sRings[r];
+        boost::lock_guard<boost::mutex> lock(ring->mMutex);
+        // oldest first once the ring has wrapped
+        size_t begin = ring->mCount > TRACE_RING_SIZE ? ring->mCount - TRACE_RING_SIZE : 0;
+        for( size_t i = begin; i < ring->mCount; i++ ) {
+            const TraceEvent &event = ring->mEvents[i % TRACE_RING_SIZE];
+            file << ( first ? "\n" : ",\n" ) << "{\"name\": \"" << event.mName << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << ring->mLane
+                << ", \"ts\": " << (long long)( event.mStart * 1e6 ) << ", \"dur\": " << (long long)( ( event.mEnd - event.mStart ) * 1e6 ) << "}";
+            first = false;
+        }
+    }
+    file << "\n]}" << endl;
+}
+
+#else
+#include <iostream>
+
+double Trace::now() { return 0.0; }
+void Trace::record(const char *name, double start, double end) {}
+// F1 lands here in builds without TRACE, so say why no trace appears
+void Trace::write()
+{
+    cerr << "tracing disabled: build the Trace configuration, or define TRACE" << endl;
+}
+
+#endif
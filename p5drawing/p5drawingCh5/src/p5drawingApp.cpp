@@ -1,38 +1,237 @@
-#include "cinder/app/AppBasic.h"
+#include "Headless.h"
 #include "cinder/gl/gl.h"
-#include "Circle.h"
-#include <list>
+#include "InputLog.h"
+#include "Trace.h"
+#include "Circles.h"
+#include "SleepLayer.h"
+#include "Philox.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+#include <cstdlib>
 using namespace ci;
 using namespace ci::app;
 using namespace std;
 
-class p5drawingApp : public AppBasic {
+class p5drawingApp : public AppBase {
 public:
+    p5drawingApp();
     void setup();
     void update();
     void draw();
-    list<Circle> circles;
+    void keyDown(KeyEvent event);
+    bool setOption(const string &name, const string &value);
+    void spawn();
+    void benchmarkGrid();
+    Circles circles;
+    // circles launched per frame
+    int spawnCount;
+    // 'p' switches between updating circles on the pool and on the main thread only
+    bool parallel;
+    WorkerPool pool;
+    // 'b' switches between drawing every circle in one call and one call per circle
+    bool batched;
+    CircleRenderer renderer;
+    // 'c' turns circle to circle collisions on and off
+    bool collisions;
+    // 's' turns sleeping on and off; sleepers are drawn from layer
+    bool sleeping;
+    SleepLayer layer;
+    // sleepers rest against the edges of the window they fell asleep in
+    Vec2i windowSize;
+    // draws each new circle's variation; seeded from Rand after input.setup so recordings replay the same circles
+    Philox random;
+    
+    // headless runs print the grid benchmark once setup() is done
+    bool gridBenchmark;
+    
+    // P5_RECORD / P5_REPLAY input sessions, see InputLog.h
+    InputLog input;
 };
 
+void p5drawingApp::keyDown(KeyEvent event)
+{
+    if( event.getCode() == KeyEvent::KEY_F1 ){
+        Trace::write();
+        return;
+    }
+    if( event.getChar() == 'p' ){
+        parallel = ! parallel;
+        console() << ( parallel ? "parallel update" : "serial update" ) << endl;
+    }
+    if( event.getChar() == 'b' ){
+        batched = ! batched;
+        console() << ( ! batched ? "one draw call per circle" : renderer.isInstanced() ? "instanced circles" : "expanded circle triangles" ) << endl;
+    }
+    if( event.getChar() == 'c' ){
+        collisions = ! collisions;
+        console() << ( collisions ? "collisions on" : "collisions off" ) << endl;
+    }
+    if( event.getChar() == 's' ){
+        sleeping = ! sleeping;
+        if( ! sleeping ){
+            circles.wakeAll();
+        }
+        console() << ( sleeping ? "sleeping on" : "sleeping off" ) << endl;
+    }
+}
+
+// defaults for what setOption() can change, which runs before setup()
+p5drawingApp::p5drawingApp()
+{
+    spawnCount = 1;
+    parallel = true;
+    batched = true;
+    collisions = true;
+    sleeping = true;
+    gridBenchmark = false;
+}
+
 void p5drawingApp::setup()
 {       
-    circles.push_back( Circle(100.0f, 100.0f) );
+    input.setup(this);
+    random = Philox( Rand::randInt() );
+    windowSize = getWindowSize();
+    if( gridBenchmark ){
+        benchmarkGrid();
+    }
+    spawn();
+}
+
+// headless benchmark options, see Headless.h
+bool p5drawingApp::setOption(const string &name, const string &value)
+{
+    if( name == "--spawn" ){
+        spawnCount = max( 1, atoi( value.c_str() ) );
+        return true;
+    }
+    if( name == "--parallel" ){
+        parallel = atoi( value.c_str() ) != 0;
+        return true;
+    }
+    if( name == "--batch" ){
+        batched = atoi( value.c_str() ) != 0;
+        return true;
+    }
+    if( name == "--collide" ){
+        collisions = atoi( value.c_str() ) != 0;
+        return true;
+    }
+    if( name == "--sleep" ){
+        sleeping = atoi( value.c_str() ) != 0;
+        return true;
+    }
+    // 0, the default, never caps the circles or retires sleepers
+    if( name == "--max-circles" ){
+        circles.mMaxCircles = max( 0, atoi( value.c_str() ) );
+        return true;
+    }
+    if( name == "--grid-benchmark" ){
+        gridBenchmark = atoi( value.c_str() ) != 0;
+        return true;
+    }
+    return false;
+}
+
+void p5drawingApp::spawn()
+{
+    // under a cap, only as many as there is room for; sleep() retires sleepers
+    // to make more, so spawning stops only if every circle is awake
+    int count = spawnCount;
+    if( circles.mMaxCircles > 0 ){
+        size_t room = circles.getTotal() < circles.mMaxCircles ? circles.mMaxCircles - circles.getTotal() : 0;
+        count = (int)min( (size_t)count, room );
+    }
+    if( count == 0 ){
+        return;
+    }
+    vector<float> variations( count );
+    random.fillFloat( &variations[0], count, 0.9f, 1.1f );
+    for( int i = 0; i < count; i++ ){
+        circles.add( Vec2f(100.0f, 100.0f), variations[i] );
+    }
+}
+
+// Times the grid build and a collision pass over random circles at a fixed
+// density of one circle per 200 square pixels, about one per two cells, so if
+// both scale linearly the time per circle stays flat as the count grows. The
+// first frame sees the circles in random order; collide() leaves them sorted
+// by cell, so the frames after it show the steady state the app runs in.
+void p5drawingApp::benchmarkGrid()
+{
+    console() << "grid benchmark, " << pool.getThreadCount() << " threads" << endl;
+    const size_t counts[] = { 10000, 100000, 1000000, 4000000 };
+    const int frames = 4;
+    Philox positions( 1 );
+    for( int c = 0; c < 4; c++ ){
+        size_t count = counts[c];
+        int side = (int)sqrt( count * 200.0f );
+        vector<float> values( count * 4 );
+        positions.fillFloat( &values[0], count * 2, 0.0f, side );
+        positions.fillFloat( &values[count * 2], count * 2, -5.0f, 5.0f );
+        
+        Circles bench;
+        bench.reserve( count );
+        for( size_t i = 0; i < count; i++ ){
+            bench.add( Vec2f(values[i], values[count + i]), 1.0f );
+            bench.mVelocityX[i] = values[count * 2 + i];
+            bench.mVelocityY[i] = values[count * 3 + i];
+        }
+        
+        double buildSeconds[frames];
+        double collideSeconds[frames];
+        for( int frame = 0; frame < frames; frame++ ){
+            Timer timer;
+            timer.start();
+            bench.mGrid.build( bench.mX, bench.mY, count, side, side, bench.mRadius * 2.0f, pool );
+            timer.stop();
+            buildSeconds[frame] = timer.getSeconds();
+            timer.start();
+            bench.collide( Vec2i(side, side), pool );
+            timer.stop();
+            collideSeconds[frame] = timer.getSeconds();
+        }
+        
+        console() << "  " << count << " circles, ns per circle: first frame build " << buildSeconds[0] * 1e9 / count
+            << ", build and collide " << collideSeconds[0] * 1e9 / count << "; steady build " << buildSeconds[frames - 1] * 1e9 / count
+            << ", build and collide " << collideSeconds[frames - 1] * 1e9 / count << endl;
+    }
 }
 
 void p5drawingApp::update()
 {   
-    for( list<Circle>::iterator i = circles.begin(); i != circles.end(); ++i ) {
-        i->update();
+    TRACE_ZONE("update");
+    input.update(this);
+    if( getWindowSize() != windowSize ){
+        circles.wakeAll();
+        windowSize = getWindowSize();
+    }
+    if( parallel ){
+        circles.update( getWindowSize(), pool );
+        if( collisions ){
+            circles.collide( getWindowSize(), pool );
+        }
+    } else {
+        circles.update( getWindowSize() );
+        if( collisions ){
+            circles.collide( getWindowSize() );
+        }
+    }
+    if( sleeping ){
+        circles.sleep( getWindowSize() );
     }
-    circles.push_back( Circle(100.0f, 100.0f) );
+    spawn();
 }
 
 void p5drawingApp::draw()
 {
+    TRACE_ZONE("draw");
     gl::clear();
-    for( list<Circle>::iterator i = circles.begin(); i != circles.end(); ++i ) {
-        i->draw();
+    layer.draw( circles, renderer, getWindowSize() );
+    if( batched ){
+        circles.draw( renderer );
+    } else {
+        circles.draw();
     }
 }
 
-CINDER_APP_BASIC( p5drawingApp, RendererGl )
\ No newline at end of file
+CINDER_APP( p5drawingApp, RendererGl )
\ No newline at end of file
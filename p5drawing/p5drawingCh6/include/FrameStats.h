@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Per-frame update and draw times collected by the headless runner, reported
+// as percentiles. write() appends one JSON object per line to a file so runs
+// of several apps and scenarios collect in one place and diff line by line:
+//   {"name": "...", "frames": 300, "update": {"p50": ..., "p95": ..., "p99": ..., "max": ...}, "draw": {...}}
+// Times are in milliseconds.
+class FrameStats {
+public:
+    void add(double updateSeconds, double drawSeconds);
+    bool write(const string &path, const string &name);
+    
+    // The p'th percentile of times in milliseconds, by nearest rank
+    static double percentile(vector<double> times, double p);
+    static string summary(const vector<double> &times);
+    
+    vector<double> mUpdate, mDraw;
+};
@@ -1,7 +1,7 @@
 #pragma once
-#include "cinder/app/AppBasic.h"
+#include "cinder/Vector.h"
+#include "cinder/Color.h"
 using namespace ci;
-using namespace ci::app;
 using namespace std;
 
 class Quad {
@@ -0,0 +1,41 @@
+#include "FrameStats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+void FrameStats::add(double updateSeconds, double drawSeconds)
+{
+    mUpdate.push_back(updateSeconds);
+    mDraw.push_back(drawSeconds);
+}
+
+double FrameStats::percentile(vector<double> times, double p)
+{
+    if( times.empty() ) {
+        return 0.0;
+    }
+    sort(times.begin(), times.end());
+    size_t rank = (size_t)ceil(p / 100.0 * times.size());
+    rank = min(max(rank, (size_t)1), times.size());
+    return times[rank - 1] * 1000.0;
+}
+
+string FrameStats::summary(const vector<double> &times)
+{
+    char text[160];
+    sprintf(text, "{\"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}",
+        percentile(times, 50), percentile(times, 95), percentile(times, 99), percentile(times, 100));
+    return text;
+}
+
+bool FrameStats::write(const string &path, const string &name)
+{
+    ofstream file(path.c_str(), ios::app);
+    if( ! file ) {
+        return false;
+    }
+    file << "{\"name\": \"" << name << "\", \"frames\": " << mUpdate.size()
+        << ", \"update\": " << summary(mUpdate) << ", \"draw\": " << summary(mDraw) << "}" << endl;
+    return true;
+}
@@ -1,14 +1,18 @@
-#include "cinder/app/AppBasic.h"
+#include "Headless.h"
 #include "cinder/gl/gl.h"
+#include "InputLog.h"
+#include "Trace.h"
 #include<list>
 #include "cinder/CinderMath.h"
 #include "Quad.h"
+#include <cstdlib>
 using namespace ci;
 using namespace ci::app;
 using namespace std;
 
-class p5drawingApp : public AppBasic {
+class p5drawingApp : public AppBase {
 public:
+    p5drawingApp();
     void setup();
     void update();
     void draw();
@@ -16,6 +20,8 @@ public:
     
     void mouseDrag(MouseEvent event);
     void mouseUp(MouseEvent event);
+    void keyDown(KeyEvent event);
+    bool setOption(const string &name, const string &value);
     
     Vec2f mousePos, mouseLast, mouseDir, mouseDirPlus, mouseDirMinus;
     Vec3f vStart, vEnd, vA, vB, vC, vD, vZero; 
@@ -25,6 +31,12 @@ public:
     int valAverageCount;
     
     float angleOrig, anglePlus, angleMinus, perpLength;
+    
+    // drives mousePos along a figure eight instead of the mouse, for headless benchmarks
+    bool syntheticStroke;
+    
+    // P5_RECORD / P5_REPLAY input sessions, see InputLog.h
+    InputLog input;
 };
 
 void p5drawingApp::mouseUp(MouseEvent event)
@@ -39,8 +51,35 @@ void p5drawingApp::mouseDrag(MouseEvent event)
     mousePos = event.getPos();
 }
 
+// headless benchmark options, see Headless.h
+bool p5drawingApp::setOption(const string &name, const string &value)
+{
+    if( name == "--stroke" ){
+        syntheticStroke = atoi(value.c_str()) != 0;
+        return true;
+    }
+    if( name == "--replay" ){
+        return input.startReplay(value);
+    }
+    return false;
+}
+
+void p5drawingApp::keyDown(KeyEvent event)
+{
+    if( event.getCode() == KeyEvent::KEY_F1 ){
+        Trace::write();
+    }
+}
+
+// defaults for what setOption() can change, which runs before setup()
+p5drawingApp::p5drawingApp()
+{
+    syntheticStroke = false;
+}
+
 void p5drawingApp::setup()
 {       
+    input.setup(this);
     gl::clear( );
     gl::color( ColorAf(0.80f, 0.80f, 1.0f, 0.5f) );
     glEnable (GL_BLEND);
@@ -51,6 +90,12 @@ void p5drawingApp::setup()
 
 void p5drawingApp::update()
 {   
+    TRACE_ZONE("update");
+    input.update(this);
+    if( syntheticStroke ){
+        float t = getElapsedSeconds() * 2.0f;
+        mousePos = Vec2f( getWindowWidth() * (0.5f + 0.35f * sin(t)), getWindowHeight() * (0.5f + 0.25f * sin(2.0f * t)) );
+    }
     if(vA != vZero && vB != vZero){
         vD = vA;
         vC = vB;
@@ -61,6 +106,7 @@ void p5drawingApp::update()
     }
     if(vC != vZero && vD != vZero){
         if( quads.size() > 0 ){
+            TRACE_ZONE("Quad::update");
             for( list<Quad>::iterator i = quads.begin(); i != quads.end(); ++i ) {
                 i->update();
                 if( i->mDie ){
@@ -76,8 +122,10 @@ void p5drawingApp::update()
 
 void p5drawingApp::draw()
 {   
+    TRACE_ZONE("draw");
     gl::clear();
     if( quads.size() > 0 ){
+        TRACE_ZONE("Quad::draw");
         for( list<Quad>::iterator i = quads.begin(); i != quads.end(); ++i ) {
             i->draw();
         }
@@ -139,4 +187,4 @@ void p5drawingApp::extractPerpendiculars()
     mouseLast = mousePos;
 }
 
-CINDER_APP_BASIC( p5drawingApp, RendererGl ) 
\ No newline at end of file
+CINDER_APP( p5drawingApp, RendererGl ) 
\ No newline at end of file
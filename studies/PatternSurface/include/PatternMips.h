@@ -0,0 +1,32 @@
+#pragma once
+#include "cinder/cairo/Cairo.h"
+#include "cinder/Surface.h"
+#include <vector>
+
+using namespace ci;
+using namespace std;
+
+// A repeating pattern kept as a mip chain of premultiplied ARGB32 surfaces,
+// cairo's native image format, so fills never convert pixels. Level n is a 2x2
+// box filter of level n - 1 down to 1x1, and its pattern matrix scales it back
+// up to the size of the source. Fills that draw the image smaller than its
+// pixels take a smaller level instead of letting cairo sample the full image
+// sparsely, which shimmers as the scale changes and reads far more memory.
+class PatternMips {
+public:
+	PatternMips();
+	
+	// Converts source once and rebuilds every level
+	void setSource(Surface8u &source);
+	
+	// The level to fill with when one source pixel covers scale device pixels
+	cairo::PatternSurface& get(double scale);
+	// How many device pixels one user space unit of ctx covers
+	static double getScale(cairo::Context &ctx);
+	
+	size_t getMemorySize() const;
+	
+	int mWidth, mHeight;
+	vector<cairo::SurfaceImage> mLevels;
+	vector<cairo::PatternSurface> mPatterns;
+};
@@ -0,0 +1,55 @@
+#pragma once
+#include "cinder/Area.h"
+#include "cinder/cairo/Cairo.h"
+#include "PlanarImage.h"
+#include <boost/thread.hpp>
+#include <string>
+#include <list>
+#include <map>
+#include <deque>
+
+using namespace ci;
+using namespace std;
+
+// A source image kept on disk as square tiles, for images too big to decode
+// at once. A tile set is a directory holding tiles.txt, which reads
+// "width height tileSize", and one tile_<column>_<row>.png per tile. Tiles are
+// decoded on demand into a least-recently-used cache that stays within the
+// memory budget, and a background thread prefetches the tiles around the
+// visible region. Every method may be called from any thread.
+class TiledImage {
+public:
+	TiledImage(const string &directory, size_t memoryBudget);
+	~TiledImage();
+	
+	// Cuts surface into a tile set in directory, to try tile sets out on small images
+	static void writeTiles(Surface32f surface, const string &directory, int tileSize);
+	
+	// The tile at column, row, decoded now if it is not cached
+	PlanarImage getTile(int column, int row);
+	// Mean color inside area, clipped to the image
+	Colorf getMean(Area area);
+	// Copies area into an image surface, e.g. as the source of a PatternSurface
+	cairo::SurfaceImage getRegion(Area area);
+	// Replaces the prefetch queue with the uncached tiles touching visible and a one tile margin around it
+	void prefetch(Area visible);
+	
+	bool isCached(int key);
+	PlanarImage loadTile(int column, int row);
+	void insert(int key, PlanarImage tile);
+	void prefetchLoop();
+	
+	string mDirectory;
+	int mWidth, mHeight, mTileSize, mColumns, mRows;
+	size_t mBudget, mBytes;
+	
+	// cached tiles by row * mColumns + column, each with its place in mRecent
+	map< int, pair< PlanarImage, list<int>::iterator > > mTiles;
+	// tile keys, most recently used first
+	list<int> mRecent;
+	deque<int> mQueue;
+	bool mQuit;
+	boost::mutex mMutex;
+	boost::condition_variable mWake;
+	boost::thread mPrefetcher;
+};
@@ -1,5 +1,10 @@
 #include "cinder/app/AppBasic.h"
 #include "cinder/cairo/Cairo.h"
+#include "TiledImage.h"
+#include "PatternMips.h"
+#include "WindowBuffers.h"
+#include "Trace.h"
+#include <boost/shared_ptr.hpp>
 using namespace ci;
 using namespace ci::app;
 using namespace std;
@@ -10,28 +15,110 @@ public:
 	void setup();
 	void update();
 	void draw();
+	void keyDown(KeyEvent event);
 	
 	cairo::PatternSurface mPattern;
+	WindowBuffers mBuffers;
+	
+	// the same image as a premultiplied mip chain; 'm' switches between the
+	// two, '-' and '=' scale the filled shape down and up
+	PatternMips mMips;
+	bool mUseMips;
+	float mScale;
+	
+	// an out-of-core tile set replacing sunset.png once opened with 't'; the
+	// pattern then holds just the visible region, panned with the arrow keys
+	boost::shared_ptr<TiledImage> mTiles;
+	Area mPatternArea;
+	Vec2i mViewOffset;
 };
 
+void cairoApp::keyDown(KeyEvent event)
+{
+	if( event.getCode() == KeyEvent::KEY_F1 ) {
+		Trace::write();
+		return;
+	}
+	if( event.getChar() == 'm' ) {
+		mUseMips = ! mUseMips;
+		console() << ( mUseMips ? "mip chain, " : "plain pattern, " ) << mMips.getMemorySize() << " bytes of levels" << endl;
+	} else if( event.getChar() == '-' ) {
+		mScale = max(mScale * 0.8f, 0.01f);
+	} else if( event.getChar() == '=' ) {
+		mScale = min(mScale * 1.25f, 4.0f);
+	}
+	
+	if( event.getChar() == 't' ) {
+		string directory = getFolderPath();
+		if( ! directory.empty() ) {
+			mTiles = boost::shared_ptr<TiledImage>( new TiledImage(directory, 256 * 1024 * 1024) );
+			mViewOffset = Vec2i(0, 0);
+			mPatternArea = Area();
+		}
+	}
+	
+	if( mTiles ) {
+		Vec2i step = Vec2i(getWindowWidth() / 2, getWindowHeight() / 2);
+		if( event.getCode() == KeyEvent::KEY_LEFT ) {
+			mViewOffset.x = max(mViewOffset.x - step.x, 0);
+		} else if( event.getCode() == KeyEvent::KEY_RIGHT ) {
+			mViewOffset.x = min(mViewOffset.x + step.x, max(mTiles->mWidth - getWindowWidth(), 0));
+		} else if( event.getCode() == KeyEvent::KEY_UP ) {
+			mViewOffset.y = max(mViewOffset.y - step.y, 0);
+		} else if( event.getCode() == KeyEvent::KEY_DOWN ) {
+			mViewOffset.y = min(mViewOffset.y + step.y, max(mTiles->mHeight - getWindowHeight(), 0));
+		}
+	}
+}
+
 void cairoApp::setup()
 {
 	mPattern = cairo::PatternSurface( loadImage( loadResource("sunset.png")));
 	mPattern.setExtendRepeat();
+	Surface8u image = Surface8u( loadImage( loadResource("sunset.png") ) );
+	mMips.setSource( image );
+	mUseMips = true;
+	mScale = 1.0f;
 }
 
 void cairoApp::update()
 {
+	TRACE_ZONE("update");
+	if( ! mTiles ) {
+		return;
+	}
+	
+	// rebuild the pattern from the tiles only when the visible region moves
+	Area visible = Area(mViewOffset.x, mViewOffset.y, mViewOffset.x + getWindowWidth(), mViewOffset.y + getWindowHeight());
+	mTiles->prefetch(visible);
+	if( visible != mPatternArea ) {
+		cairo::SurfaceImage region = mTiles->getRegion(visible);
+		mPattern = cairo::PatternSurface(region);
+		mPattern.setExtendRepeat();
+		mMips.setSource(region.getSurface());
+		mPatternArea = visible;
+	}
 }
 
 void cairoApp::draw()
 {
-	cairo::Context ctx( cairo::createWindowSurface() );     
+	TRACE_ZONE("draw");
+	cairo::Context &ctx = mBuffers.begin( getWindowWidth(), getWindowHeight() );
 	ctx.setSource(Colorf(0,0,0));
 	ctx.paint();
-	ctx.setSource( mPattern );
-	ctx.circle(Vec2f(200,200), 100);
+	
+	// scaled about the window origin, so keep the circle centered on the same spot
+	ctx.save();
+	ctx.scale(mScale, mScale);
+	if( mUseMips ) {
+		ctx.setSource( mMips.get( PatternMips::getScale(ctx) ) );
+	} else {
+		ctx.setSource( mPattern );
+	}
+	ctx.circle(Vec2f(200,200) / mScale, 100);
 	ctx.fill();
+	ctx.restore();
+	mBuffers.present();
 }
 
 CINDER_APP_BASIC( cairoApp, Renderer2d )
\ No newline at end of file
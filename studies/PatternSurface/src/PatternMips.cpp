@@ -0,0 +1,106 @@
+#include "PatternMips.h"
+#include <cmath>
+#include <algorithm>
+
+PatternMips::PatternMips()
+	: mWidth(0), mHeight(0)
+{
+}
+
+static uint32_t premultiply(uint32_t color, uint32_t alpha)
+{
+	return ( color * alpha + 127 ) / 255;
+}
+
+// averages the 2x2 blocks of source into a surface half its size, rounding
+// odd sizes up and repeating the last row or column
+static cairo::SurfaceImage halve(cairo::SurfaceImage &source)
+{
+	int width = source.getWidth();
+	int height = source.getHeight();
+	cairo::SurfaceImage result( max( ( width + 1 ) / 2, 1 ), max( ( height + 1 ) / 2, 1 ), true );
+	
+	const uint8_t *data = source.getData();
+	int stride = source.getStride();
+	uint8_t *resultData = result.getData();
+	for( int y = 0; y < result.getHeight(); y++ ){
+		const uint32_t *row0 = (const uint32_t*)( data + min( y * 2, height - 1 ) * stride );
+		const uint32_t *row1 = (const uint32_t*)( data + min( y * 2 + 1, height - 1 ) * stride );
+		uint32_t *out = (uint32_t*)( resultData + y * result.getStride() );
+		for( int x = 0; x < result.getWidth(); x++ ){
+			int x0 = min( x * 2, width - 1 );
+			int x1 = min( x * 2 + 1, width - 1 );
+			uint32_t pixel = 0;
+			// premultiplied channels average independently
+			for( int shift = 0; shift < 32; shift += 8 ){
+				uint32_t sum = ( ( row0[x0] >> shift ) & 0xff ) + ( ( row0[x1] >> shift ) & 0xff )
+					+ ( ( row1[x0] >> shift ) & 0xff ) + ( ( row1[x1] >> shift ) & 0xff );
+				pixel |= ( ( sum + 2 ) / 4 ) << shift;
+			}
+			out[x] = pixel;
+		}
+	}
+	result.markDirty();
+	return result;
+}
+
+void PatternMips::setSource(Surface8u &source)
+{
+	mWidth = source.getWidth();
+	mHeight = source.getHeight();
+	mLevels.clear();
+	mPatterns.clear();
+	
+	cairo::SurfaceImage base( mWidth, mHeight, true );
+	uint8_t *data = base.getData();
+	int stride = base.getStride();
+	bool hasAlpha = source.hasAlpha();
+	Surface8u::Iter iter = source.getIter();
+	while( iter.line() ){
+		uint32_t *row = (uint32_t*)( data + iter.y() * stride );
+		while( iter.pixel() ){
+			uint32_t alpha = hasAlpha ? iter.a() : 255;
+			row[iter.x()] = ( alpha << 24 ) | ( premultiply( iter.r(), alpha ) << 16 ) | ( premultiply( iter.g(), alpha ) << 8 ) | premultiply( iter.b(), alpha );
+		}
+	}
+	base.markDirty();
+	mLevels.push_back( base );
+	
+	while( mLevels.back().getWidth() > 1 || mLevels.back().getHeight() > 1 ){
+		mLevels.push_back( halve( mLevels.back() ) );
+	}
+	
+	for( size_t i = 0; i < mLevels.size(); i++ ){
+		cairo::PatternSurface pattern( mLevels[i] );
+		pattern.setExtendRepeat();
+		// pattern space is the level's own pixels, user space the source's
+		pattern.setMatrix( cairo::Matrix( (double)mLevels[i].getWidth() / mWidth, 0, 0, (double)mLevels[i].getHeight() / mHeight, 0, 0 ) );
+		mPatterns.push_back( pattern );
+	}
+}
+
+cairo::PatternSurface& PatternMips::get(double scale)
+{
+	int level = 0;
+	if( scale > 0.0 && scale < 1.0 ){
+		level = (int)floor( log( 1.0 / scale ) / log( 2.0 ) + 0.5 );
+	}
+	level = min( level, (int)mPatterns.size() - 1 );
+	return mPatterns[max( level, 0 )];
+}
+
+double PatternMips::getScale(cairo::Context &ctx)
+{
+	cairo::Matrix matrix;
+	ctx.getMatrix( &matrix );
+	return sqrt( fabs( matrix.xx * matrix.yy - matrix.xy * matrix.yx ) );
+}
+
+size_t PatternMips::getMemorySize() const
+{
+	size_t bytes = 0;
+	for( size_t i = 0; i < mLevels.size(); i++ ){
+		bytes += mLevels[i].getWidth() * mLevels[i].getHeight() * 4;
+	}
+	return bytes;
+}
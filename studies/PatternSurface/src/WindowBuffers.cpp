@@ -0,0 +1,32 @@
+#include "WindowBuffers.h"
+
+WindowBuffers::WindowBuffers()
+	: mWidth(0), mHeight(0), mBack(0)
+{
+}
+
+cairo::Context& WindowBuffers::begin(int width, int height)
+{
+	if( width != mWidth || height != mHeight ) {
+		for( int i = 0; i < 2; i++ ) {
+			mBuffers[i] = cairo::SurfaceImage(width, height, false);
+			mContexts[i] = cairo::Context(mBuffers[i]);
+		}
+		mWindow = cairo::Context( cairo::createWindowSurface() );
+		mWidth = width;
+		mHeight = height;
+	}
+	
+	mBack = 1 - mBack;
+	cairo::Context &ctx = mContexts[mBack];
+	// the context outlives the frame, so drop any transform left over from the last one
+	ctx.identityMatrix();
+	return ctx;
+}
+
+void WindowBuffers::present()
+{
+	mBuffers[mBack].flush();
+	mWindow.setSourceSurface(mBuffers[mBack], 0, 0);
+	mWindow.paint();
+}